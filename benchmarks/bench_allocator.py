@@ -0,0 +1,88 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Throughput and resident memory of decoding the sample files with the
+default allocator of the context or with an ArenaAllocator reset after
+each file, in one thread or in several threads each with its own context.
+The allocations of the arena call back into Python and take the GIL, which
+serialises the threads.
+
+Run with pytest-benchmark installed:
+
+    $ pytest benchmarks/bench_allocator.py
+
+The resident set size after the rounds is reported as "rss_bytes".
+"""
+
+import concurrent.futures
+import os
+import pathlib
+import resource
+
+import pytest
+
+import eccodes
+
+SAMPLE_DATA_FOLDER = pathlib.Path(__file__).parent.parent / "tests" / "sample-data"
+TEST_FILES = sorted(SAMPLE_DATA_FOLDER.glob("*.grib*"))
+THREADS = 4
+
+
+def rss_bytes():
+    try:
+        with open("/proc/self/statm") as statm:
+            return int(statm.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+    except OSError:
+        # Peak rather than current size, in kilobytes on Linux but bytes on MacOS
+        return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+
+
+def decode_files(context, arena):
+    for path in TEST_FILES:
+        with open(path, "rb") as file:
+            while True:
+                gid = eccodes.codes_grib_new_from_file(file, context=context)
+                if gid is None:
+                    break
+                eccodes.codes_get_values(gid)
+                eccodes.codes_release(gid)
+        if arena is not None:
+            arena.reset()
+
+
+@pytest.mark.parametrize("allocator", ["default", "arena"])
+def test_decode_files(benchmark, allocator):
+    arena = eccodes.ArenaAllocator() if allocator == "arena" else None
+    context = eccodes.codes_context_new(allocator=arena)
+    benchmark(decode_files, context, arena)
+    benchmark.extra_info["rss_bytes"] = rss_bytes()
+    if arena is not None:
+        benchmark.extra_info["arena_bytes_reserved"] = arena.bytes_reserved
+
+
+def decode_files_threads(contexts, arena):
+    with concurrent.futures.ThreadPoolExecutor(len(contexts)) as executor:
+        # The arena is reset once all the threads are done with their messages
+        list(executor.map(decode_files, contexts, [None] * len(contexts)))
+    if arena is not None:
+        arena.reset()
+
+
+@pytest.mark.parametrize("allocator", ["default", "arena"])
+def test_decode_files_threads(benchmark, allocator):
+    arena = eccodes.ArenaAllocator() if allocator == "arena" else None
+    contexts = [eccodes.codes_context_new(allocator=arena) for _ in range(THREADS)]
+    benchmark(decode_files_threads, contexts, arena)
+    benchmark.extra_info["threads"] = THREADS
+    benchmark.extra_info["rss_bytes"] = rss_bytes()
+    if arena is not None:
+        benchmark.extra_info["arena_bytes_reserved"] = arena.bytes_reserved
@@ -0,0 +1,94 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Extraction of the headers of all the messages of a BUFR file, and the number
+of allocations of the library per message, with and without a recycled buffer.
+
+Run with pytest-benchmark installed:
+
+    $ pytest benchmarks/bench_bufr.py
+"""
+
+import pytest
+
+import eccodes
+from eccodes.highlevel import recycled_handles
+
+
+class CountingArena(eccodes.ArenaAllocator):
+    """An arena counting the allocations made by the library"""
+
+    def __init__(self):
+        super().__init__()
+        self.mallocs = 0
+
+    def malloc(self, size):
+        self.mallocs += 1
+        return super().malloc(size)
+
+
+def extract_headers(path):
+    return sum(1 for _ in eccodes.codes_bufr_extract_headers(str(path)))
+
+
+def read_headers(path, context=None):
+    count = 0
+    with open(path, "rb") as file:
+        while True:
+            bufrid = eccodes.codes_new_from_file(
+                file, eccodes.CODES_PRODUCT_BUFR, context=context
+            )
+            if bufrid is None:
+                break
+            eccodes.codes_get(bufrid, "typicalDate")
+            eccodes.codes_release(bufrid)
+            count += 1
+    return count
+
+
+def read_headers_recycled(path, context=None):
+    count = 0
+    for bufrid in recycled_handles(str(path), eccodes.CODES_PRODUCT_BUFR, context):
+        eccodes.codes_get(bufrid, "typicalDate")
+        count += 1
+    return count
+
+
+READERS = {"new_from_file": read_headers, "recycled": read_headers_recycled}
+
+
+def test_bufr_extract_headers(benchmark, bufr_file):
+    benchmark.extra_info["messages"] = benchmark(extract_headers, bufr_file)
+
+
+def test_bufr_read_headers(benchmark, bufr_file):
+    benchmark(read_headers, bufr_file)
+
+
+def test_bufr_read_headers_recycled(benchmark, bufr_file):
+    benchmark(read_headers_recycled, bufr_file)
+
+
+@pytest.mark.parametrize("reader", list(READERS))
+def test_bufr_allocations(benchmark, bufr_file, reader):
+    arena = CountingArena()
+    context = eccodes.codes_context_new(allocator=arena)
+    read = READERS[reader]
+
+    def run():
+        arena.reset()
+        return read(bufr_file, context)
+
+    count = run()
+    benchmark.extra_info["allocations_per_message"] = arena.mallocs / count
+    benchmark.extra_info["bytes_per_message"] = arena.bytes_allocated / count
+    benchmark(run)
@@ -0,0 +1,90 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Reading GRIB messages: iteration, decoding of the values and scans of the
+header keys or of all the keys, on each file of tests/sample-data and on a
+large file.
+
+Run with pytest-benchmark installed:
+
+    $ pytest benchmarks/bench_decode.py
+"""
+
+import eccodes
+
+HEADER_KEYS = [
+    "edition",
+    "centre",
+    "dataDate",
+    "dataTime",
+    "stepRange",
+    "typeOfLevel",
+    "level",
+    "shortName",
+    "paramId",
+    "gridType",
+]
+
+
+def iterate_messages(path):
+    with eccodes.FileReader(path) as reader:
+        return sum(1 for _ in reader)
+
+
+def decode_values(path):
+    with eccodes.FileReader(path) as reader:
+        return sum(message.data.size for message in reader)
+
+
+def scan_header_keys(path):
+    with open(path, "rb") as file:
+        while True:
+            gid = eccodes.codes_grib_new_from_file(file, headers_only=True)
+            if gid is None:
+                break
+            for key in HEADER_KEYS:
+                eccodes.codes_get(gid, key)
+            eccodes.codes_release(gid)
+
+
+def read_items(path):
+    with eccodes.FileReader(path) as reader:
+        return sum(len(list(message.items())) for message in reader)
+
+
+def get_data(path):
+    with open(path, "rb") as file:
+        gid = eccodes.codes_grib_new_from_file(file)
+    try:
+        return eccodes.codes_grib_get_data(gid)
+    finally:
+        eccodes.codes_release(gid)
+
+
+def test_iterate_messages(benchmark, grib_file):
+    benchmark.extra_info["messages"] = benchmark(iterate_messages, grib_file)
+
+
+def test_decode_values(benchmark, grib_file):
+    benchmark.extra_info["values"] = benchmark(decode_values, grib_file)
+
+
+def test_scan_header_keys(benchmark, grib_file):
+    benchmark(scan_header_keys, grib_file)
+
+
+def test_read_items(benchmark, grib_file):
+    benchmark.extra_info["items"] = benchmark(read_items, grib_file)
+
+
+def test_grib_get_data(benchmark, grib_file):
+    benchmark(get_data, grib_file)
@@ -0,0 +1,79 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Time of ``import eccodes`` in a new interpreter, and of the first call
+opening the library. The import time of eccodes itself, not counting numpy,
+is reported as "own_import_time".
+
+Run with pytest-benchmark installed:
+
+    $ pytest benchmarks/bench_import.py
+
+Generate the precompiled declarations first to measure the fast path:
+
+    $ python builder.py --abi
+
+The import must stay within the budget of ECCODES_PYTHON_IMPORT_BUDGET milliseconds,
+50 by default.
+"""
+
+import os
+import subprocess
+import sys
+
+import pytest
+
+IMPORT_BUDGET = float(os.environ.get("ECCODES_PYTHON_IMPORT_BUDGET", "50")) / 1000
+
+
+def run(statement):
+    return subprocess.run(
+        [sys.executable, "-X", "importtime", "-c", statement],
+        capture_output=True,
+        text=True,
+        check=True,
+    )
+
+
+def own_import_time(stderr):
+    """Return the import time of eccodes without numpy, in seconds"""
+    # -X importtime prints "import time: self [us] | cumulative | imported package"
+    cumulative = {}
+    for line in stderr.splitlines():
+        if line.startswith("import time:"):
+            _, total, name = line.split("|")
+            if total.strip().isdigit():
+                cumulative.setdefault(name.strip(), int(total))
+    return (cumulative["eccodes"] - cumulative.get("numpy", 0)) / 1e6
+
+
+@pytest.fixture(scope="module", autouse=True)
+def warm_bytecode_cache():
+    run("import eccodes")
+
+
+def test_import(benchmark):
+    own_times = []
+
+    def import_eccodes():
+        own_times.append(own_import_time(run("import eccodes").stderr))
+
+    benchmark.pedantic(import_eccodes, rounds=5)
+    benchmark.extra_info["own_import_time"] = min(own_times)
+    benchmark.extra_info["budget"] = IMPORT_BUDGET
+    assert min(own_times) < IMPORT_BUDGET
+
+
+def test_import_and_first_call(benchmark):
+    benchmark.pedantic(
+        run, args=("import eccodes; eccodes.codes_get_api_version()",), rounds=5
+    )
@@ -0,0 +1,50 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+FileIndex of eccodes.messages: build from a file, load from its index file
+and selection of a subindex.
+
+Run with pytest-benchmark installed:
+
+    $ pytest benchmarks/bench_index.py
+"""
+
+from eccodes import messages
+
+INDEX_KEYS = ["shortName", "typeOfLevel", "level", "number", "dataDate", "step"]
+
+
+def test_fileindex_build(benchmark, grib_file):
+    filestream = messages.FileStream(str(grib_file))
+    benchmark(messages.FileIndex.from_filestream, filestream, INDEX_KEYS)
+
+
+def test_fileindex_load(benchmark, grib_file, tmp_path):
+    filestream = messages.FileStream(str(grib_file))
+    indexpath = str(tmp_path / "{short_hash}.idx")
+    index = messages.FileIndex.from_indexpath_or_filestream(
+        filestream, INDEX_KEYS, indexpath
+    )
+    loaded = benchmark(
+        messages.FileIndex.from_indexpath_or_filestream,
+        filestream,
+        INDEX_KEYS,
+        indexpath,
+    )
+    assert loaded.offsets == index.offsets
+
+
+def test_fileindex_subindex(benchmark, grib_file):
+    filestream = messages.FileStream(str(grib_file))
+    index = messages.FileIndex.from_filestream(filestream, INDEX_KEYS)
+    query = {key: index[key][0] for key in INDEX_KEYS[:2]}
+    benchmark(index.subindex, **query)
@@ -0,0 +1,60 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Nearest grid point queries on the first message of each sample file.
+
+Run with pytest-benchmark installed:
+
+    $ pytest benchmarks/bench_nearest.py
+"""
+
+import numpy as np
+import pytest
+
+import eccodes
+
+POINTS = [(lat, lon) for lat in range(-80, 90, 20) for lon in range(0, 360, 40)]
+
+
+@pytest.fixture
+def gid(grib_file):
+    with open(grib_file, "rb") as file:
+        gid = eccodes.codes_grib_new_from_file(file)
+    yield gid
+    eccodes.codes_release(gid)
+
+
+def find_nearest_each(gid):
+    for lat, lon in POINTS:
+        eccodes.codes_grib_find_nearest(gid, lat, lon)
+
+
+def find_nearest_reused(gid):
+    nid = eccodes.codes_grib_nearest_new(gid)
+    for lat, lon in POINTS:
+        eccodes.codes_grib_nearest_find(
+            nid, gid, lat, lon, eccodes.CODES_GRIB_NEAREST_SAME_GRID
+        )
+    eccodes.codes_grib_nearest_delete(nid)
+
+
+def test_find_nearest(benchmark, gid):
+    benchmark(find_nearest_each, gid)
+
+
+def test_find_nearest_reused(benchmark, gid):
+    benchmark(find_nearest_reused, gid)
+
+
+def test_find_nearest_multiple(benchmark, gid):
+    lats, lons = (np.array(coords, dtype=float) for coords in zip(*POINTS))
+    benchmark(eccodes.codes_grib_find_nearest_multiple, gid, False, lats, lons)
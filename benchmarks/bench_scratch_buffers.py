@@ -0,0 +1,91 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Cost of the out-parameters of the scalar getters, reused per thread
+or allocated at every call as before.
+
+Run with pytest-benchmark installed:
+
+    $ pytest benchmarks/bench_scratch_buffers.py
+
+The number of cdata allocated per round is reported as "ffi_new_per_round".
+"""
+
+import pathlib
+
+import pytest
+
+import eccodes
+from gribapi import gribapi
+
+SAMPLE_DATA_FOLDER = pathlib.Path(__file__).parent.parent / "tests" / "sample-data"
+TEST_GRIB_DATA = SAMPLE_DATA_FOLDER / "era5-levels-members.grib"
+
+LONG_KEYS = ["edition", "centre", "dataDate", "dataTime", "level", "number"]
+DOUBLE_KEYS = ["latitudeOfFirstGridPointInDegrees", "iDirectionIncrementInDegrees"]
+STRING_KEYS = ["shortName", "typeOfLevel", "gridType"]
+
+
+class CountingFFI:
+    def __init__(self, ffi):
+        self._ffi = ffi
+        self.count = 0
+
+    def new(self, *args):
+        self.count += 1
+        return self._ffi.new(*args)
+
+    def __getattr__(self, name):
+        return getattr(self._ffi, name)
+
+
+class FreshScratch:
+    """Allocate the out-parameters at every call, as before the scratch buffers."""
+
+    err_p = property(lambda self: gribapi.ffi.new("int *"))
+    int_p = property(lambda self: gribapi.ffi.new("int *"))
+    long_p = property(lambda self: gribapi.ffi.new("long *"))
+    double_p = property(lambda self: gribapi.ffi.new("double *"))
+    size_p = property(lambda self: gribapi.ffi.new("size_t *"))
+
+    def char_buffer(self, length):
+        return gribapi.ffi.new("char[]", length)
+
+
+@pytest.fixture
+def gid():
+    with open(TEST_GRIB_DATA, "rb") as file:
+        gid = eccodes.codes_grib_new_from_file(file)
+    yield gid
+    eccodes.codes_release(gid)
+
+
+def read_keys(gid):
+    for key in LONG_KEYS:
+        eccodes.codes_get_long(gid, key)
+    for key in DOUBLE_KEYS:
+        eccodes.codes_get_double(gid, key)
+    for key in STRING_KEYS:
+        eccodes.codes_get_string(gid, key)
+        eccodes.codes_get_size(gid, key)
+
+
+@pytest.mark.parametrize("scratch", ["thread-local", "fresh"])
+def test_read_scalar_keys(benchmark, monkeypatch, gid, scratch):
+    if scratch == "fresh":
+        monkeypatch.setattr(gribapi, "_scratch", FreshScratch())
+    read_keys(gid)  # fill the key names cache
+    counting_ffi = CountingFFI(gribapi.ffi)
+    monkeypatch.setattr(gribapi, "ffi", counting_ffi)
+    read_keys(gid)
+    benchmark.extra_info["ffi_new_per_round"] = counting_ffi.count
+    benchmark(read_keys, gid)
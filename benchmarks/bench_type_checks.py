@@ -0,0 +1,77 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Per-call cost of the argument type-checks on a key-reading loop.
+
+Run with pytest-benchmark installed:
+
+    $ pytest benchmarks/bench_type_checks.py
+"""
+
+import pathlib
+
+import pytest
+
+import eccodes
+from gribapi import gribapi
+
+SAMPLE_DATA_FOLDER = pathlib.Path(__file__).parent.parent / "tests" / "sample-data"
+TEST_GRIB_DATA = SAMPLE_DATA_FOLDER / "era5-levels-members.grib"
+
+KEYS = [
+    "edition",
+    "centre",
+    "dataDate",
+    "dataTime",
+    "stepRange",
+    "typeOfLevel",
+    "level",
+    "shortName",
+    "paramId",
+    "number",
+    "gridType",
+    "Ni",
+    "Nj",
+    "packingType",
+    "bitsPerValue",
+]
+
+
+@pytest.fixture
+def gid():
+    with open(TEST_GRIB_DATA, "rb") as file:
+        gid = eccodes.codes_grib_new_from_file(file)
+    yield gid
+    eccodes.codes_release(gid)
+
+
+@pytest.fixture
+def type_checks():
+    saved = gribapi.enable_type_checks, gribapi.enable_fast_path
+    yield eccodes.codes_set_type_checks
+    eccodes.codes_set_type_checks(*saved)
+
+
+def read_keys(gid):
+    for key in KEYS:
+        eccodes.codes_get(gid, key)
+
+
+@pytest.mark.parametrize(
+    "flag,fast_path",
+    [(False, True), (True, True), (True, False)],
+    ids=["unchecked", "checked-fast-path", "checked"],
+)
+def test_read_keys(benchmark, gid, type_checks, flag, fast_path):
+    type_checks(flag, fast_path=fast_path)
+    benchmark.extra_info["calls_per_round"] = len(KEYS)
+    benchmark(read_keys, gid)
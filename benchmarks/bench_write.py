@@ -0,0 +1,45 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Writing messages: copies of the messages of each sample file, and of
+messages modified from a sample.
+
+Run with pytest-benchmark installed:
+
+    $ pytest benchmarks/bench_write.py
+"""
+
+import eccodes
+
+
+def copy_file(path, out_path):
+    with eccodes.FileReader(path) as reader, open(out_path, "wb") as out:
+        for message in reader:
+            message.write_to(out)
+
+
+def write_from_sample(out_path, count=100):
+    with open(out_path, "wb") as out:
+        for step in range(count):
+            message = eccodes.GRIBMessage.from_samples("regular_ll_sfc_grib2")
+            message["step"] = step
+            message.write_to(out)
+
+
+def test_copy_messages(benchmark, grib_file, tmp_path):
+    out_path = tmp_path / "out.grib"
+    benchmark(copy_file, grib_file, out_path)
+    assert out_path.stat().st_size == grib_file.stat().st_size
+
+
+def test_write_from_sample(benchmark, tmp_path):
+    benchmark(write_from_sample, tmp_path / "out.grib")
@@ -0,0 +1,70 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Input files of the benchmarks: the GRIB files in tests/sample-data, a
+larger file made of ECCODES_BENCH_REPEAT copies of their messages (20 by
+default), and GRIB and BUFR files generated by synthetic.py, created once
+per session. The synthetic GRIB file has ECCODES_BENCH_MESSAGES messages
+(100 by default) on a grid of ECCODES_BENCH_GRID points (360x181 by default).
+eccodes is imported by the fixtures only, as this conftest is also loaded
+when the functional tests are collected.
+"""
+
+import os
+import pathlib
+
+import pytest
+
+SAMPLE_DATA_FOLDER = pathlib.Path(__file__).parent.parent / "tests" / "sample-data"
+SAMPLE_GRIB_FILES = sorted(SAMPLE_DATA_FOLDER.glob("*.grib*"))
+REPEAT = int(os.environ.get("ECCODES_BENCH_REPEAT", "20"))
+MESSAGES = int(os.environ.get("ECCODES_BENCH_MESSAGES", "100"))
+GRID = os.environ.get("ECCODES_BENCH_GRID", "360x181")
+
+
+@pytest.fixture(scope="session")
+def large_grib_file(tmp_path_factory):
+    path = tmp_path_factory.mktemp("data") / "large.grib"
+    with open(path, "wb") as file:
+        for _ in range(REPEAT):
+            for source in SAMPLE_GRIB_FILES:
+                file.write(source.read_bytes())
+    return path
+
+
+@pytest.fixture(scope="session")
+def synthetic_grib_file(tmp_path_factory):
+    import synthetic
+
+    path = tmp_path_factory.mktemp("data") / "synthetic.grib2"
+    synthetic.write_grib(path, count=MESSAGES, grid=synthetic.parse_grid(GRID))
+    return path
+
+
+@pytest.fixture(scope="session")
+def bufr_file(tmp_path_factory):
+    import synthetic
+
+    path = tmp_path_factory.mktemp("data") / "large.bufr"
+    synthetic.write_bufr(path, count=2 * REPEAT)
+    return path
+
+
+@pytest.fixture(
+    params=[path.name for path in SAMPLE_GRIB_FILES] + ["large", "synthetic"],
+    ids=[path.stem for path in SAMPLE_GRIB_FILES] + ["large", "synthetic"],
+)
+def grib_file(request):
+    """Each GRIB file in tests/sample-data, then the large and synthetic files"""
+    if request.param in ("large", "synthetic"):
+        return request.getfixturevalue(f"{request.param}_grib_file")
+    return SAMPLE_DATA_FOLDER / request.param
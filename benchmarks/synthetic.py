@@ -0,0 +1,201 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Generate large GRIB and BUFR files from the samples installed with ecCodes,
+for benchmarks at scale. The files only depend on the arguments, so the same
+multi-GB files can be recreated anywhere offline:
+
+    $ python benchmarks/synthetic.py grib large.grib2 --grid 1440x721 --size 2G
+    $ python benchmarks/synthetic.py grib large.grib1 --edition 1 --count 1000
+    $ python benchmarks/synthetic.py bufr large.bufr --count 100000
+"""
+
+import argparse
+import sys
+
+import numpy as np
+
+import eccodes
+
+# shortName, typeOfLevel, levels
+PARAMETERS = [
+    ("t", "isobaricInhPa", [1000, 850, 700, 500, 300, 200, 100]),
+    ("u", "isobaricInhPa", [1000, 850, 700, 500, 300, 200, 100]),
+    ("v", "isobaricInhPa", [1000, 850, 700, 500, 300, 200, 100]),
+    ("z", "isobaricInhPa", [1000, 850, 700, 500, 300, 200, 100]),
+    ("2t", "heightAboveGround", [2]),
+    ("msl", "meanSea", [0]),
+]
+
+BUFR_SAMPLES = ["BUFR3_local_satellite", "BUFR4_local_satellite"]
+
+SUFFIXES = {"K": 1024, "M": 1024**2, "G": 1024**3}
+
+
+def grid_template(edition, ni, nj, packing, bits_per_value):
+    """Return a regular lat/lon message of ni x nj points from the samples"""
+    gid = eccodes.codes_grib_new_from_samples(f"regular_ll_pl_grib{edition}")
+    eccodes.codes_set_key_vals(
+        gid,
+        {
+            "Ni": ni,
+            "Nj": nj,
+            "latitudeOfFirstGridPointInDegrees": 90.0,
+            "longitudeOfFirstGridPointInDegrees": 0.0,
+            "latitudeOfLastGridPointInDegrees": -90.0,
+            "longitudeOfLastGridPointInDegrees": 360.0 - 360.0 / ni,
+            "iDirectionIncrementInDegrees": 360.0 / ni,
+            "jDirectionIncrementInDegrees": 180.0 / (nj - 1),
+        },
+    )
+    eccodes.codes_set_values(gid, np.zeros(ni * nj))
+    eccodes.codes_set(gid, "packingType", packing)
+    eccodes.codes_set(gid, "bitsPerValue", bits_per_value)
+    return gid
+
+
+def smooth_field(ni, nj, seed):
+    """Return a reproducible field with large scale patterns and some noise"""
+    random = np.random.RandomState(seed)
+    lats = np.radians(np.linspace(90.0, -90.0, nj))[:, None]
+    lons = np.radians(np.linspace(0.0, 360.0, ni, endpoint=False))[None, :]
+    waves = random.randint(2, 8)
+    field = np.cos(lats) * (1.0 + 0.3 * np.sin(waves * lons + random.uniform(0, 6)))
+    return (field + 0.01 * random.standard_normal((nj, ni))).ravel()
+
+
+def write_grib(
+    path,
+    count=None,
+    size=None,
+    edition=2,
+    grid=(360, 181),
+    packing="grid_simple",
+    bits_per_value=16,
+    parameters=PARAMETERS,
+    seed=0,
+):
+    """
+    Write a GRIB file of @em count messages, or of at least @em size bytes,
+    cycling over the steps, parameters and levels.
+
+    @param grid             the number of points (Ni, Nj) of the regular lat/lon grid
+    @param packing          the packingType of the messages, e.g. grid_simple, grid_ccsds
+    @param parameters       list of (shortName, typeOfLevel, levels)
+    @return number of messages written
+    """
+    if count is None and size is None:
+        raise ValueError("count or size must be given")
+    ni, nj = grid
+    template = grid_template(edition, ni, nj, packing, bits_per_value)
+    fields = [smooth_field(ni, nj, seed + i) for i in range(len(parameters))]
+    written = 0
+    try:
+        with open(path, "wb") as file:
+            while True:
+                step = 6 * (written // sum(len(p[2]) for p in parameters))
+                for (short_name, type_of_level, levels), field in zip(
+                    parameters, fields
+                ):
+                    for level in levels:
+                        if written == count or (size and file.tell() >= size):
+                            return written
+                        gid = eccodes.codes_clone(template)
+                        eccodes.codes_set_key_vals(
+                            gid,
+                            {
+                                "shortName": short_name,
+                                "typeOfLevel": type_of_level,
+                                "level": level,
+                                "step": step,
+                            },
+                        )
+                        # An unknown combination silently gives another parameter
+                        if eccodes.codes_get(gid, "shortName") != short_name:
+                            eccodes.codes_release(gid)
+                            raise ValueError(
+                                f"{short_name} is not defined on {type_of_level}"
+                            )
+                        scale = 50.0 + 0.01 * level
+                        eccodes.codes_set_values(gid, scale * field + 0.1 * step)
+                        eccodes.codes_write(gid, file)
+                        eccodes.codes_release(gid)
+                        written += 1
+    finally:
+        eccodes.codes_release(template)
+
+
+def write_bufr(path, count=None, size=None, samples=BUFR_SAMPLES):
+    """
+    Write a BUFR file of @em count messages, or of at least @em size bytes,
+    alternating the BUFR @em samples.
+
+    @return number of messages written
+    """
+    if count is None and size is None:
+        raise ValueError("count or size must be given")
+    bufrids = [eccodes.codes_bufr_new_from_samples(sample) for sample in samples]
+    written = 0
+    try:
+        with open(path, "wb") as file:
+            while written != count and not (size and file.tell() >= size):
+                eccodes.codes_write(bufrids[written % len(bufrids)], file)
+                written += 1
+    finally:
+        for bufrid in bufrids:
+            eccodes.codes_release(bufrid)
+    return written
+
+
+def parse_size(text):
+    if text[-1].upper() in SUFFIXES:
+        return int(float(text[:-1]) * SUFFIXES[text[-1].upper()])
+    return int(text)
+
+
+def parse_grid(text):
+    ni, nj = text.lower().split("x")
+    return int(ni), int(nj)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("kind", choices=["grib", "bufr"])
+    parser.add_argument("path")
+    parser.add_argument("--count", type=int, help="number of messages")
+    parser.add_argument("--size", type=parse_size, help="minimum size, e.g. 2G")
+    parser.add_argument("--edition", type=int, choices=[1, 2], default=2)
+    parser.add_argument("--grid", type=parse_grid, default="360x181")
+    parser.add_argument("--packing", default="grid_simple")
+    parser.add_argument("--bits-per-value", type=int, default=16)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args(argv)
+    if args.count is None and args.size is None:
+        parser.error("one of --count or --size is required")
+    if args.kind == "grib":
+        written = write_grib(
+            args.path,
+            count=args.count,
+            size=args.size,
+            edition=args.edition,
+            grid=args.grid,
+            packing=args.packing,
+            bits_per_value=args.bits_per_value,
+            seed=args.seed,
+        )
+    else:
+        written = write_bufr(args.path, count=args.count, size=args.size)
+    print(f"{args.path}: {written} messages")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,19 +1,52 @@
+import hashlib
 import logging
+import os
 import sys
 
 import cffi
 
+HERE = os.path.dirname(os.path.abspath(__file__))
+HEADERS = b"".join(
+    open(os.path.join(HERE, "gribapi", header), "rb").read()
+    for header in ("grib_api.h", "eccodes.h")
+)
+CDEF = HEADERS.decode("utf-8").replace("\r", "\n")
+
+# API level, out-of-line mode: compiled against the ecCodes headers
 ffibuilder = cffi.FFI()
 ffibuilder.set_source(
     "gribapi._bindings",
-    "#include <eccodes.h>",
+    """
+    #include <eccodes.h>
+    /* Not in the public headers */
+    grib_context* grib_context_new(grib_context* parent);
+    """,
     libraries=["eccodes"],
 )
-ffibuilder.cdef(open("gribapi/grib_api.h").read() + open("gribapi/eccodes.h").read())
+ffibuilder.cdef(CDEF)
+
+# ABI level, out-of-line mode: the declarations are parsed once and saved in
+# a Python module, no compiler nor headers are needed
+ffibuilder_abi = cffi.FFI()
+ffibuilder_abi.set_source("gribapi._bindings_abi", None)
+ffibuilder_abi.cdef(CDEF)
+
+
+def build_abi(tmpdir="."):
+    """Write gribapi/_bindings_abi.py under tmpdir, with the hash of the headers"""
+    path = ffibuilder_abi.compile(tmpdir=tmpdir, verbose=True)
+    # Checked by bindings.load_precompiled, the headers may change after the build
+    with open(path, "a") as file:
+        file.write("CDEF_HASH = %r\n" % hashlib.sha1(HEADERS).hexdigest())
+    return path
+
 
 if __name__ == "__main__":
     try:
-        ffibuilder.compile(verbose=True)
+        if "--abi" in sys.argv[1:]:
+            build_abi(HERE)
+        else:
+            ffibuilder.compile(verbose=True)
     except Exception:
         logging.exception("can't compile ecCodes bindings")
         sys.exit(1)
@@ -10,5 +10,17 @@
 #
 #
 
+from .cache import set_handle_cache  # noqa
 from .eccodes import *  # noqa
+from .eccodes import codes_get_api_version
+from .eccodes import codes_get_stats as stats  # noqa
+from .eccodes import codes_live_handles as live_handles  # noqa
+from .eccodes import codes_reset_stats as reset_stats  # noqa
 from .highlevel import *  # noqa
+from .tracing import MemoryTracer, set_tracer  # noqa
+
+
+def __getattr__(name):
+    if name == "__version__":
+        return codes_get_api_version()
+    raise AttributeError(f"module {__name__!r} has no attribute {name!r}")
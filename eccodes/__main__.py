@@ -10,16 +10,49 @@
 #
 
 import argparse
+import concurrent.futures
+import csv
+import json
+import os
+import sys
+import time
 
 from . import (
+    CODES_PRODUCT_ANY,
+    CODES_PRODUCT_BUFR,
+    CODES_PRODUCT_GRIB,
+    FileReader,
     codes_definition_path,
+    codes_extract_offsets,
     codes_get_api_version,
     codes_get_library_path,
     codes_samples_path,
+    messages,
 )
+from . import references as reference_sets
+from . import table
 
+SCAN_KEYS = [
+    "edition",
+    "centre",
+    "dataDate",
+    "dataTime",
+    "stepRange",
+    "typeOfLevel",
+    "level",
+    "shortName",
+]
 
-def selfcheck():
+INDEX_KEYS = ["shortName", "typeOfLevel", "level", "number", "dataDate", "step"]
+
+PRODUCTS = {
+    "any": CODES_PRODUCT_ANY,
+    "grib": CODES_PRODUCT_GRIB,
+    "bufr": CODES_PRODUCT_BUFR,
+}
+
+
+def selfcheck(argv=()):
     print("Found: ecCodes v%s." % codes_get_api_version())
     print("Library:", codes_get_library_path())
     print("Definitions:", codes_definition_path())
@@ -27,12 +60,181 @@ def selfcheck():
     print("Your system is ready.")
 
 
+def comma_list(text):
+    return [item for item in text.split(",") if item]
+
+
+def scan_file(path, keys, product="grib", start=0, stop=None):
+    """Return the offset, length and header keys of each message of a file
+
+    With the "grib" product the messages are loaded headers only, otherwise in full.
+    Only the messages from the offset start up to the offset stop are read."""
+    columns = table.scan_columns(path, keys, PRODUCTS[product], start=start, stop=stop)
+    return [{"path": path, **dict(zip(columns, row))} for row in zip(*columns.values())]
+
+
+def split_file(path, product, parts):
+    """Return the (path, start, stop) ranges of the messages of a file in parts"""
+    offsets = list(codes_extract_offsets(path, PRODUCTS[product]))
+    step = max(1, -(-len(offsets) // parts))
+    starts = offsets[::step] or [0]
+    return [(path, start, stop) for start, stop in zip(starts, starts[1:] + [None])]
+
+
+def scan(argv):
+    parser = argparse.ArgumentParser(
+        prog="python -m eccodes scan",
+        description="List the offset, length and header keys of the messages of files",
+    )
+    parser.add_argument("paths", nargs="+", metavar="path")
+    parser.add_argument("--keys", type=comma_list, default=SCAN_KEYS)
+    parser.add_argument(
+        "--product",
+        choices=list(PRODUCTS),
+        default="grib",
+        help="the GRIB messages are loaded headers only, use any for other products",
+    )
+    parser.add_argument("--format", choices=["csv", "json"], default="csv")
+    parser.add_argument(
+        "--workers",
+        type=int,
+        default=1,
+        help="number of processes, the messages of each file are split between them",
+    )
+    args = parser.parse_args(argv)
+
+    if args.workers > 1:
+        ranges = [
+            r for p in args.paths for r in split_file(p, args.product, args.workers)
+        ]
+        paths, starts, stops = zip(*ranges)
+        with concurrent.futures.ProcessPoolExecutor(args.workers) as executor:
+            results = executor.map(
+                scan_file,
+                paths,
+                [args.keys] * len(ranges),
+                [args.product] * len(ranges),
+                starts,
+                stops,
+            )
+            rows = [row for rows in results for row in rows]
+    else:
+        rows = [
+            row for p in args.paths for row in scan_file(p, args.keys, args.product)
+        ]
+
+    if args.format == "json":
+        json.dump(rows, sys.stdout, indent=1, default=str)
+        print()
+    else:
+        writer = csv.DictWriter(sys.stdout, ["path", "offset", "length"] + args.keys)
+        writer.writeheader()
+        writer.writerows(rows)
+
+
+def references(argv):
+    parser = argparse.ArgumentParser(
+        prog="python -m eccodes references",
+        description="Write the byte ranges and header keys of the messages of a file",
+    )
+    parser.add_argument("path")
+    parser.add_argument("--keys", type=comma_list, default=SCAN_KEYS)
+    parser.add_argument(
+        "--product",
+        choices=list(PRODUCTS),
+        default="grib",
+        help="the GRIB messages are loaded headers only, use any for other products",
+    )
+    parser.add_argument("--format", choices=["json", "npz"], default="json")
+    parser.add_argument("--output", help="default is {path}.refs.{format}")
+    args = parser.parse_args(argv)
+
+    output = args.output or f"{args.path}.refs.{args.format}"
+    refs = reference_sets.scan_references(args.path, args.keys, PRODUCTS[args.product])
+    with open(output, "wb") as file:
+        reference_sets.dump(refs, file, args.format)
+    print(f"{output}: {len(refs['refs'])} messages")
+
+
+def index(argv):
+    parser = argparse.ArgumentParser(
+        prog="python -m eccodes index",
+        description="Build the index files of files, or rebuild them if they are older",
+    )
+    parser.add_argument("paths", nargs="+", metavar="path")
+    parser.add_argument("--keys", type=comma_list, default=INDEX_KEYS)
+    parser.add_argument("--indexpath", default="{path}.{short_hash}.idx")
+    parser.add_argument("--force", action="store_true", help="always rebuild")
+    args = parser.parse_args(argv)
+
+    for path in args.paths:
+        filestream = messages.FileStream(path)
+        indexpath = messages.FileIndex.format_indexpath(
+            filestream, args.keys, args.indexpath
+        )
+        if os.path.exists(indexpath) and (
+            args.force or os.path.getmtime(indexpath) < os.path.getmtime(path)
+        ):
+            os.remove(indexpath)
+        start = time.perf_counter()
+        fileindex = filestream.index(args.keys, args.indexpath)
+        count = sum(len(offsets) for _, offsets in fileindex.offsets)
+        elapsed = time.perf_counter() - start
+        print(f"{indexpath}: {count} messages in {elapsed:.3f}s")
+
+
+def read_file(path, decode):
+    count = 0
+    with FileReader(path) as reader:
+        for message in reader:
+            if decode:
+                message.data
+            count += 1
+    return count
+
+
+def bench(argv):
+    parser = argparse.ArgumentParser(
+        prog="python -m eccodes bench",
+        description="Measure the rate of reading and decoding the messages of files",
+    )
+    parser.add_argument("paths", nargs="+", metavar="path")
+    parser.add_argument("--repeat", type=int, default=3, help="keep the best of runs")
+    args = parser.parse_args(argv)
+    if args.repeat < 1:
+        parser.error("--repeat must be at least 1")
+
+    print(f"{'':8} {'messages':>9} {'seconds':>9} {'messages/s':>11} {'MB/s':>9}  path")
+    for path in args.paths:
+        size = os.path.getsize(path)
+        for name, decode in [("read", False), ("decode", True)]:
+            best = float("inf")
+            for _ in range(args.repeat):
+                start = time.perf_counter()
+                count = read_file(path, decode)
+                best = min(best, time.perf_counter() - start)
+            print(
+                f"{name:8} {count:9d} {best:9.3f} {count / best:11.1f}"
+                f" {size / best / 1e6:9.1f}  {path}"
+            )
+
+
+COMMANDS = {
+    "selfcheck": selfcheck,
+    "scan": scan,
+    "index": index,
+    "references": references,
+    "bench": bench,
+}
+
+
 def main(argv=None):
-    parser = argparse.ArgumentParser()
-    parser.add_argument("command")
+    parser = argparse.ArgumentParser(prog="python -m eccodes")
+    parser.add_argument("command", help=", ".join(COMMANDS))
+    parser.add_argument("args", nargs=argparse.REMAINDER)
     args = parser.parse_args(args=argv)
-    if args.command == "selfcheck":
-        selfcheck()
+    if args.command in COMMANDS:
+        COMMANDS[args.command](args.args)
     else:
         raise RuntimeError(
             "Command not recognised %r. See usage with --help." % args.command
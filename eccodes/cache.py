@@ -0,0 +1,199 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+import collections
+import os
+import threading
+
+from . import eccodes
+
+
+def nbytes(value):
+    return getattr(value, "nbytes", 0)
+
+
+class LRUCache:
+    """
+    Cache of at most max_bytes, evicting the least recently used items first.
+
+    The size of each item is given by sizeof, the nbytes of numpy arrays by default.
+    Items larger than the whole budget are not cached. All the methods are thread-safe.
+    """
+
+    def __init__(self, max_bytes, sizeof=nbytes):
+        self.max_bytes = max_bytes
+        self.sizeof = sizeof
+        self._items = collections.OrderedDict()
+        # Reentrant as the items may be discarded by finalizers run by the
+        # garbage collector in a thread holding the lock
+        self._lock = threading.RLock()
+        self.nbytes = 0
+        self.hits = 0
+        self.misses = 0
+        self.evictions = 0
+
+    def get(self, key, default=None):
+        with self._lock:
+            try:
+                value, _ = self._items[key]
+                self._items.move_to_end(key)
+            except KeyError:
+                self.misses += 1
+                return default
+            self.hits += 1
+            return value
+
+    def put(self, key, value):
+        size = self.sizeof(value)
+        with self._lock:
+            self._put(key, value, size)
+
+    def setdefault(self, key, value):
+        """Return the value cached for key, or cache value and return it"""
+        size = self.sizeof(value)
+        with self._lock:
+            item = self._items.get(key)
+            if item is not None:
+                self._items.move_to_end(key)
+                return item[0]
+            self._put(key, value, size)
+            return value
+
+    def _put(self, key, value, size):
+        self._discard(key)
+        if size > self.max_bytes:
+            return
+        self._items[key] = (value, size)
+        self.nbytes += size
+        while self.nbytes > self.max_bytes:
+            _, (_, evicted_size) = self._items.popitem(last=False)
+            self.nbytes -= evicted_size
+            self.evictions += 1
+
+    def _discard(self, key):
+        item = self._items.pop(key, None)
+        if item is not None:
+            self.nbytes -= item[1]
+
+    def discard(self, key):
+        with self._lock:
+            self._discard(key)
+
+    def clear(self):
+        with self._lock:
+            self._items.clear()
+            self.nbytes = 0
+
+    def __len__(self):
+        return len(self._items)
+
+    def __contains__(self, key):
+        return key in self._items
+
+    def info(self):
+        """Return the hits, misses, evictions, number of items, bytes and budget"""
+        with self._lock:
+            return {
+                "hits": self.hits,
+                "misses": self.misses,
+                "evictions": self.evictions,
+                "items": len(self._items),
+                "nbytes": self.nbytes,
+                "max_bytes": self.max_bytes,
+            }
+
+
+def read_handle(file, offset, product_kind=eccodes.CODES_PRODUCT_ANY):
+    """Read the message at offset, or (offset, field in a multi-field message)"""
+    field_in_message = 0
+    if isinstance(offset, tuple):
+        offset, field_in_message = offset
+    file.seek(offset)
+    codes_id = None
+    for _ in range(field_in_message + 1):
+        codes_id = eccodes.codes_new_from_file(file, product_kind=product_kind)
+    if codes_id is None:
+        raise EOFError("End of file: %r" % file)
+    return eccodes.Handle(codes_id)
+
+
+class _Entry:
+    def __init__(self, handle):
+        self.handle = handle
+        self.values = None
+        self.nbytes = eccodes.codes_get_message_size(handle)
+        # Held while the values are decoded, so they are decoded once
+        self.lock = threading.Lock()
+
+
+class HandleCache(LRUCache):
+    """
+    Cache of the messages read at an offset of a file, and of their values.
+
+    The entries are keyed by (real path, offset, modification time) so a file
+    changed on disk is read again. The handles and values returned are shared:
+    they must not be modified nor released. The messages built from the handles
+    are clones, parsed and decoded again, so for them the cache only saves the
+    reads from the file. The values are only decoded once, by ``values``.
+    """
+
+    def __init__(self, max_bytes):
+        super().__init__(max_bytes, sizeof=lambda entry: entry.nbytes)
+
+    def _entry(self, path, offset, product_kind, file=None):
+        path = os.path.realpath(path)
+        key = (path, offset, os.stat(path).st_mtime_ns)
+        entry = self.get(key)
+        if entry is None:
+            if file is None:
+                with open(path, "rb") as file:
+                    entry = _Entry(read_handle(file, offset, product_kind))
+            else:
+                entry = _Entry(read_handle(file, offset, product_kind))
+            # Another thread may have read the same message meanwhile
+            entry = self.setdefault(key, entry)
+        return key, entry
+
+    def handle(self, path, offset, product_kind=eccodes.CODES_PRODUCT_ANY, file=None):
+        """Return the handle of the message at offset in path, read from file if given"""
+        return self._entry(path, offset, product_kind, file)[1].handle
+
+    def values(self, path, offset, product_kind=eccodes.CODES_PRODUCT_ANY, file=None):
+        """Return the read-only values of the message at offset in path"""
+        key, entry = self._entry(path, offset, product_kind, file)
+        with entry.lock:
+            if entry.values is None:
+                values = eccodes.codes_get_values(entry.handle)
+                values.flags.writeable = False
+                entry.values = values
+                entry.nbytes += values.nbytes
+                # account for the size of the values
+                self.put(key, entry)
+        return entry.values
+
+
+_handle_cache = None
+
+
+def set_handle_cache(max_bytes):
+    """
+    Cache the messages read at an offset, by FileIndex, FileReader.read_at and
+    Message.from_file, in a process-wide cache of max_bytes, 0 to disable it.
+
+    Return the cache, its info() method gives its hits and misses.
+    """
+    global _handle_cache
+    _handle_cache = HandleCache(max_bytes) if max_bytes else None
+    return _handle_cache
+
+
+def get_handle_cache():
+    return _handle_cache
@@ -22,7 +22,19 @@ from gribapi import GRIB_MISSING_LONG as CODES_MISSING_LONG
 from gribapi import GRIB_NEAREST_SAME_DATA as CODES_GRIB_NEAREST_SAME_DATA
 from gribapi import GRIB_NEAREST_SAME_GRID as CODES_GRIB_NEAREST_SAME_GRID
 from gribapi import GRIB_NEAREST_SAME_POINT as CODES_GRIB_NEAREST_SAME_POINT
-from gribapi import __version__
+from gribapi import (
+    Allocator,
+    ArenaAllocator,
+    BufrKeysIterator,
+    CodesObject,
+    Context,
+    GeoIterator,
+    Handle,
+    Index,
+    KeysIterator,
+    MultiHandle,
+    Nearest,
+)
 from gribapi import any_new_from_file as codes_any_new_from_file
 from gribapi import bindings_version
 from gribapi import bufr_new_from_file as codes_bufr_new_from_file
@@ -48,9 +60,15 @@ from gribapi import (
     codes_new_from_file,
     codes_new_from_samples,
     codes_samples_path,
+    codes_scan_references,
 )
+from gribapi import get_stats as codes_get_stats
 from gribapi import grib_clone as codes_clone
+from gribapi import grib_context_bind as codes_context_bind
 from gribapi import grib_context_delete as codes_context_delete
+from gribapi import grib_context_get_bound as codes_context_get_bound
+from gribapi import grib_context_new as codes_context_new
+from gribapi import grib_context_set_allocator as codes_context_set_allocator
 from gribapi import grib_copy_namespace as codes_copy_namespace
 from gribapi import grib_count_in_file as codes_count_in_file
 from gribapi import grib_find_nearest as codes_grib_find_nearest
@@ -64,6 +82,7 @@ from gribapi import grib_get_double_array as codes_get_double_array
 from gribapi import grib_get_double_element as codes_get_double_element
 from gribapi import grib_get_double_elements as codes_get_double_elements
 from gribapi import grib_get_elements as codes_get_elements
+from gribapi import grib_get_items as codes_get_items
 from gribapi import grib_get_long as codes_get_long
 from gribapi import grib_get_long_array as codes_get_long_array
 from gribapi import grib_get_message as codes_get_message
@@ -139,7 +158,15 @@ from gribapi import grib_skip_function as codes_skip_function
 from gribapi import grib_skip_read_only as codes_skip_read_only
 from gribapi import grib_write as codes_write
 from gribapi import gts_new_from_file as codes_gts_new_from_file
+from gribapi import key_cache_clear as codes_key_cache_clear
+from gribapi import key_cache_info as codes_key_cache_info
+from gribapi import leaked_handles_report as codes_leaked_handles_report
+from gribapi import live_handles as codes_live_handles
 from gribapi import metar_new_from_file as codes_metar_new_from_file
+from gribapi import reset_stats as codes_reset_stats
+from gribapi import set_debug_handles as codes_set_debug_handles
+from gribapi import set_stats as codes_set_stats
+from gribapi import set_type_checks as codes_set_type_checks
 from gribapi.errors import (
     ArrayTooSmallError,
     AttributeClashError,
@@ -215,12 +242,12 @@ from gribapi.errors import (
 )
 
 __all__ = [
-    "__version__",
     "ArrayTooSmallError",
     "AttributeClashError",
     "AttributeNotFoundError",
     "bindings_version",
     "BufferTooSmallError",
+    "BufrKeysIterator",
     "CodeNotFoundInTableError",
     "codes_any_new_from_file",
     "codes_bufr_copy_data",
@@ -250,6 +277,7 @@ __all__ = [
     "codes_get_double",
     "codes_get_elements",
     "codes_get_gaussian_latitudes",
+    "codes_get_items",
     "codes_get_library_path",
     "codes_get_long_array",
     "codes_get_long",
@@ -305,6 +333,8 @@ __all__ = [
     "codes_index_write",
     "codes_is_defined",
     "codes_is_missing",
+    "codes_key_cache_clear",
+    "codes_key_cache_info",
     "codes_keys_iterator_delete",
     "codes_keys_iterator_get_name",
     "codes_keys_iterator_new",
@@ -325,6 +355,7 @@ __all__ = [
     "CODES_PRODUCT_METAR",
     "codes_release",
     "codes_samples_path",
+    "codes_scan_references",
     "codes_dump",
     "codes_set_array",
     "codes_set_definitions_path",
@@ -337,6 +368,13 @@ __all__ = [
     "codes_set_samples_path",
     "codes_set_string_array",
     "codes_set_string",
+    "codes_set_type_checks",
+    "codes_set_stats",
+    "codes_get_stats",
+    "codes_reset_stats",
+    "codes_live_handles",
+    "codes_set_debug_handles",
+    "codes_leaked_handles_report",
     "codes_set_values",
     "codes_set",
     "codes_skip_coded",
@@ -347,7 +385,15 @@ __all__ = [
     "codes_skip_read_only",
     "codes_write",
     "codes_context_delete",
+    "codes_context_new",
+    "codes_context_bind",
+    "codes_context_get_bound",
+    "codes_context_set_allocator",
     "CodesInternalError",
+    "Allocator",
+    "ArenaAllocator",
+    "CodesObject",
+    "Context",
     "ConceptNoMatchError",
     "ConstantFieldError",
     "CorruptedIndexError",
@@ -361,7 +407,9 @@ __all__ = [
     "FunctionalityNotEnabledError",
     "FunctionNotImplementedError",
     "GeocalculusError",
+    "GeoIterator",
     "GribInternalError",
+    "Handle",
     "HashArrayNoMatchError",
     "InternalArrayTooSmallError",
     "InternalError",
@@ -377,7 +425,9 @@ __all__ = [
     "InvalidOrderByError",
     "InvalidSectionNumberError",
     "InvalidTypeError",
+    "Index",
     "IOProblemError",
+    "KeysIterator",
     "KeyValueNotFoundError",
     "MemoryAllocationError",
     "MessageEndNotFoundError",
@@ -386,6 +436,8 @@ __all__ = [
     "MessageTooLargeError",
     "MissingBufrEntryError",
     "MissingKeyError",
+    "MultiHandle",
+    "Nearest",
     "NoDefinitionsError",
     "NoMoreInSetError",
     "NoValuesError",
@@ -412,3 +464,10 @@ __all__ = [
     "WrongStepUnitError",
     "WrongTypeError",
 ]
+
+
+def __getattr__(name):
+    # The library is only opened when the version is asked for, not at import
+    if name == "__version__":
+        return codes_get_api_version()
+    raise AttributeError(f"module {__name__!r} has no attribute {name!r}")
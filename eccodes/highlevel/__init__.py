@@ -1,2 +1,3 @@
-from .message import GRIBMessage, Message  # noqa
-from .reader import FileReader, MemoryReader, StreamReader  # noqa
+from .message import GRIBMessage, Message, set_data_cache  # noqa
+from .reader import FileReader, MemoryReader, StreamReader, recycled_handles  # noqa
+from .shared import SharedMemoryReader, SharedMessage, share  # noqa
@@ -1,7 +1,12 @@
 import io
+import itertools
+import pickle
+import weakref
 from contextlib import contextmanager
 
 import eccodes
+from eccodes import tracing
+from eccodes.cache import LRUCache
 
 _TYPES_MAP = {
     "float": float,
@@ -10,6 +15,10 @@ _TYPES_MAP = {
 }
 
 
+def _from_buffer(cls, buffer):
+    return cls(eccodes.codes_new_from_message(buffer))
+
+
 @contextmanager
 def raise_keyerror(name):
     """Make operations on a key raise a KeyError if not found"""
@@ -21,18 +30,21 @@ def raise_keyerror(name):
 
 class Message:
     def __init__(self, handle):
-        self._handle = handle
-
-    def __del__(self):
-        try:
-            eccodes.codes_release(self._handle)
-        except Exception:
-            pass
+        # The Handle owns the C handle and releases it with the last reference
+        self._handle = eccodes.Handle(handle)
 
     def copy(self):
         """Create a copy of the current message"""
         return Message(eccodes.codes_clone(self._handle))
 
+    def __reduce_ex__(self, protocol):
+        # The encoded message is pickled, out-of-band with protocol 5 when the
+        # pickler has a buffer_callback, and decoded again when unpickled
+        buffer = eccodes.codes_get_message(self._handle)
+        if protocol >= 5:
+            buffer = pickle.PickleBuffer(buffer)
+        return _from_buffer, (type(self), buffer)
+
     def __copy__(self):
         return self.copy()
 
@@ -152,12 +164,6 @@ class Message:
             self._iter_keys = iter_keys
             self._iter_values = iter_values
 
-        def __del__(self):
-            try:
-                eccodes.codes_keys_iterator_delete(self._iterator)
-            except Exception:
-                pass
-
         def __iter__(self):
             return self
 
@@ -186,11 +192,13 @@ class Message:
 
     def values(self, namespace=None):
         """Iterate over the values of all the available keys"""
-        return self._KeyIterator(self, namespace, iter_keys=False, iter_values=True)
+        return (value for _, value in self.items(namespace))
 
     def items(self, namespace=None):
-        """Iterate over all the available key-value pairs"""
-        return self._KeyIterator(self, namespace, iter_keys=True, iter_values=True)
+        """Iterate over all the available key-value pairs
+
+        The pairs are all read in one pass over the keys when the iteration starts"""
+        return iter(eccodes.codes_get_items(self._handle, namespace))
 
     def dump(self):
         """Print out a textual representation of the message"""
@@ -199,14 +207,105 @@ class Message:
     def write_to(self, fileobj):
         """Write the message to a file object"""
         assert isinstance(fileobj, io.IOBase)
-        eccodes.codes_write(self._handle, fileobj)
+        with tracing.span("eccodes.write") as span:
+            tracing.set_message_attributes(span, self._handle)
+            eccodes.codes_write(self._handle, fileobj)
 
     def get_buffer(self):
         """Return a buffer containing the encoded message"""
-        return eccodes.codes_get_message(self._handle)
+        with tracing.span("eccodes.encode") as span:
+            buffer = eccodes.codes_get_message(self._handle)
+            span.set_attribute("size", len(buffer))
+        return buffer
+
+
+class MessageDataCache:
+    """Keep the values of each message as long as the message"""
+
+    def get(self, message):
+        return message._data
+
+    def put(self, message, values):
+        message._data = values
+
+
+class NoDataCache:
+    """Decode the values at every access"""
+
+    def get(self, message):
+        return None
+
+    def put(self, message, values):
+        pass
+
+
+class WeakDataCache:
+    """Keep the values of each message as long as they are referenced elsewhere"""
+
+    def get(self, message):
+        ref = getattr(message, "_data_ref", None)
+        return None if ref is None else ref()
+
+    def put(self, message, values):
+        try:
+            message._data_ref = weakref.ref(values)
+        except TypeError:  # a single value
+            pass
+
+
+class LRUDataCache(LRUCache):
+    """Keep the values of the most recently used messages within a budget in bytes"""
+
+    _keys = itertools.count()
+
+    def __init__(self, max_bytes):
+        super().__init__(max_bytes)
+
+    def get(self, message):
+        key = getattr(message, "_data_key", None)
+        return None if key is None else super().get(key)
+
+    def put(self, message, values):
+        key = getattr(message, "_data_key", None)
+        if key is None:
+            key = message._data_key = next(self._keys)
+            weakref.finalize(message, self.discard, key)
+        super().put(key, values)
+
+
+DATA_CACHE_POLICIES = {
+    "message": MessageDataCache,
+    "none": NoDataCache,
+    "weakref": WeakDataCache,
+    "lru": LRUDataCache,
+}
+
+
+def set_data_cache(policy="message", max_bytes=256 * 1024**2):
+    """Set the cache of the values of all the GRIBMessage objects
+
+    Parameters
+    ----------
+    policy: str
+        "message" keeps the values as long as their message, the default,
+        "none" decodes them at every access, "weakref" keeps them as long as
+        they are referenced elsewhere, and "lru" keeps the values of the most
+        recently used messages of the process within ``max_bytes``.
+    max_bytes: int
+        The budget of the "lru" policy.
+
+    Returns the cache, with an ``info()`` method for the "lru" policy."""
+    if policy not in DATA_CACHE_POLICIES:
+        raise ValueError(f"Unknown data cache policy {policy!r}")
+    cache = DATA_CACHE_POLICIES[policy]
+    GRIBMessage.data_cache = cache(max_bytes) if policy == "lru" else cache()
+    return GRIBMessage.data_cache
 
 
 class GRIBMessage(Message):
+    # The cache of the values of all the messages, see set_data_cache
+    data_cache = MessageDataCache()
+
     def __init__(self, handle):
         super().__init__(handle)
         self._data = None
@@ -214,15 +313,20 @@ class GRIBMessage(Message):
     @property
     def data(self):
         """Return the array of values"""
-        if self._data is None:
-            self._data = self._get("values")
-        return self._data
+        data = self.data_cache.get(self)
+        if data is None:
+            with tracing.span("eccodes.decode") as span:
+                tracing.set_message_attributes(span, self._handle)
+                data = self._get("values")
+                span.set_attribute("values", getattr(data, "size", 1))
+            self.data_cache.put(self, data)
+        return data
 
     def get_data_points(self):
         """Get the list of ``(lat, lon, value)`` data points"""
         return eccodes.codes_grib_get_data(self._handle)
 
     @classmethod
-    def from_samples(cls, name):
+    def from_samples(cls, name, context=None):
         """Create a message from a sample"""
-        return cls(eccodes.codes_grib_new_from_samples(name))
+        return cls(eccodes.codes_grib_new_from_samples(name, context))
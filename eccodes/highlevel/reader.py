@@ -1,13 +1,18 @@
 import eccodes
 import gribapi
+from eccodes import tracing
+from eccodes.cache import get_handle_cache
+from eccodes.table import make_table, scan_columns
 from gribapi import ffi
 
 from .message import GRIBMessage
 
 
 class ReaderBase:
-    def __init__(self):
+    def __init__(self, context=None):
         self._peeked = None
+        # The messages are decoded with this context, if given
+        self.context = context
 
     def __iter__(self):
         return self
@@ -17,11 +22,21 @@ class ReaderBase:
             msg = self._peeked
             self._peeked = None
             return msg
-        handle = self._next_handle()
+        handle = self._read_handle()
         if handle is None:
             raise StopIteration
+        return self._new_message(handle)
+
+    def _new_message(self, handle):
         return GRIBMessage(handle)
 
+    def _read_handle(self):
+        with tracing.span("eccodes.read", reader=type(self).__name__) as span:
+            handle = self._next_handle()
+            if handle is not None:
+                tracing.set_message_attributes(span, handle)
+        return handle
+
     def _next_handle(self):
         raise NotImplementedError
 
@@ -34,41 +49,154 @@ class ReaderBase:
     def peek(self):
         """Return the next available message without consuming it"""
         if self._peeked is None:
-            handle = self._next_handle()
+            handle = self._read_handle()
             if handle is not None:
-                self._peeked = GRIBMessage(handle)
+                self._peeked = self._new_message(handle)
         return self._peeked
 
 
+# The first bytes of the messages of a product, the others are not filtered
+PRODUCT_MAGIC = {
+    eccodes.CODES_PRODUCT_GRIB: b"GRIB",
+    eccodes.CODES_PRODUCT_BUFR: b"BUFR",
+}
+
+
+def recycled_handles(path, product_kind=eccodes.CODES_PRODUCT_ANY, context=None):
+    """Yield the messages of a file, all read into the same buffer
+
+    The library allocates no buffer for the messages: each one is read in one
+    pass into a buffer grown to the largest message so far and decoded in place.
+    A message is released when the next one is read, any later use of it raises.
+    If objects created from it, such as keys iterators or nearest objects, are
+    still alive, it is released once they are gone and keeps the buffer until
+    then: the next messages are read into a new one."""
+    magic = PRODUCT_MAGIC.get(product_kind)
+    buffer = bytearray(64 * 1024)
+    length = ffi.new("size_t*")
+    handle = None
+    with open(path, "rb") as file:
+        stream = ffi.new_handle(file)
+        try:
+            while True:
+                if handle is not None:
+                    try:
+                        handle.release()
+                    except eccodes.InvalidGribError:
+                        handle.release(strict=False)
+                        buffer = bytearray(len(buffer))
+                    handle = None
+                start = file.tell()
+                length[0] = len(buffer)
+                err = gribapi.lib.wmo_read_any_from_stream(
+                    stream, pyread_callback, ffi.from_buffer(buffer), length
+                )
+                if err == gribapi.lib.GRIB_BUFFER_TOO_SMALL:
+                    # Only the header was read, read the message again
+                    buffer = bytearray(length[0])
+                    file.seek(start)
+                    continue
+                if err == gribapi.lib.GRIB_END_OF_FILE:
+                    break
+                gribapi.GRIB_CHECK(err)
+                view = memoryview(buffer)[: length[0]]
+                if magic is not None and view[:4] != magic:
+                    continue
+                handle = eccodes.codes_new_from_message(view, context, copy=False)
+                yield handle
+        finally:
+            if handle is not None:
+                handle.release(strict=False)
+
+
 class FileReader(ReaderBase):
-    """Read messages from a file"""
+    """Read messages from a file
+
+    With ``recycle=True`` the messages are read into one buffer reused for all of
+    them, saving an allocation and a free per message. Each message is then only
+    valid until the next one is read, see :func:`recycled_handles`."""
 
-    def __init__(self, path):
-        super().__init__()
-        self.file = open(path, "rb")
+    def __init__(self, path, context=None, recycle=False):
+        super().__init__(context)
+        self.path = path
+        self.file = None
+        self._recycled = None
+        if recycle:
+            # The file is opened by recycled_handles
+            self._recycled = recycled_handles(
+                path, eccodes.CODES_PRODUCT_GRIB, context=context
+            )
+        else:
+            self.file = open(path, "rb")
 
     def _next_handle(self):
-        return eccodes.codes_new_from_file(self.file, eccodes.CODES_PRODUCT_GRIB)
+        if self._recycled is not None:
+            return next(self._recycled, None)
+        return eccodes.codes_new_from_file(
+            self.file, eccodes.CODES_PRODUCT_GRIB, context=self.context
+        )
+
+    def scan_table(self, keys, backend=None):
+        """Return a table of the offset, length and header keys of the messages
+
+        The messages are read headers only from the start of the file, without moving
+        the iteration. The table is a pyarrow Table when pyarrow is installed, a numpy
+        record array otherwise, or as selected by ``backend``, "arrow" or "numpy"."""
+        columns = scan_columns(
+            self.path, keys, eccodes.CODES_PRODUCT_GRIB, self.context
+        )
+        return make_table(columns, backend)
+
+    def read_at(self, offset):
+        """Return the message at an offset of the file, without moving the iteration
+
+        The message is taken from the cache of ``eccodes.set_handle_cache`` if set."""
+        handle_cache = get_handle_cache()
+        if handle_cache is not None:
+            handle = handle_cache.handle(self.path, offset, eccodes.CODES_PRODUCT_GRIB)
+            return GRIBMessage(eccodes.codes_clone(handle))
+        if self.file is None:
+            with open(self.path, "rb") as file:
+                handle = self._load_at(file, offset)
+        else:
+            position = self.file.tell()
+            try:
+                handle = self._load_at(self.file, offset)
+            finally:
+                self.file.seek(position)
+        if handle is None:
+            raise EOFError(f"No message at offset {offset} of {self.path}")
+        return GRIBMessage(handle)
+
+    def _load_at(self, file, offset):
+        file.seek(offset)
+        return eccodes.codes_new_from_file(
+            file, eccodes.CODES_PRODUCT_GRIB, context=self.context
+        )
 
     def __enter__(self):
-        self.file.__enter__()
+        if self.file is not None:
+            self.file.__enter__()
         return self
 
     def __exit__(self, exc_type, exc_value, traceback):
-        return self.file.__exit__(exc_type, exc_value, traceback)
+        if self._recycled is not None:
+            self._recycled.close()
+        if self.file is not None:
+            return self.file.__exit__(exc_type, exc_value, traceback)
 
 
 class MemoryReader(ReaderBase):
     """Read messages from memory"""
 
-    def __init__(self, buf):
-        super().__init__()
+    def __init__(self, buf, context=None):
+        super().__init__(context)
         self.buf = buf
 
     def _next_handle(self):
         if self.buf is None:
             return None
-        handle = eccodes.codes_new_from_message(self.buf)
+        handle = eccodes.codes_new_from_message(self.buf, context=self.context)
         self.buf = None
         return handle
 
@@ -82,25 +210,34 @@ def pyread_callback(payload, buf, length):
     return n if n > 0 else -1  # -1 means EOF
 
 
-try:
-    cstd = ffi.dlopen(None)  # Raises OSError on Windows
-    ffi.cdef("void free(void* pointer);")
-    ffi.cdef(
-        "void* wmo_read_any_from_stream_malloc(void*, long (*stream_proc)(void*, void*, long), size_t*, int*);"
-    )
-except OSError:
-    cstd = None
+_cstd = []
+
+
+def get_cstd():
+    """Return the C standard library, opened on first use, or None on Windows"""
+    if not _cstd:
+        import cffi
 
+        cstd_ffi = cffi.FFI()
+        cstd_ffi.cdef("void free(void* pointer);")
+        try:
+            _cstd.append(cstd_ffi.dlopen(None))  # Raises OSError on Windows
+        except OSError:
+            _cstd.append(None)
+    return _cstd[0]
 
-def codes_new_from_stream(stream):
+
+def codes_new_from_stream(stream, context=None):
+    cstd = get_cstd()
     if cstd is None:
         raise OSError("This feature is not supported on Windows")
     sh = ffi.new_handle(stream)
     length = ffi.new("size_t*")
-    err = ffi.new("int*")
-    err, buf = gribapi.err_last(gribapi.lib.wmo_read_any_from_stream_malloc)(
-        sh, pyread_callback, length
-    )
+    with tracing.span("eccodes.stream_read") as span:
+        err, buf = gribapi.err_last(gribapi.lib.wmo_read_any_from_stream_malloc)(
+            sh, pyread_callback, length
+        )
+        span.set_attribute("size", length[0])
     buf = ffi.gc(buf, cstd.free, size=length[0])
     if err:
         if err != gribapi.lib.GRIB_END_OF_FILE:
@@ -108,21 +245,23 @@ def codes_new_from_stream(stream):
         return None
 
     # TODO: remove the extra copy?
-    handle = gribapi.lib.grib_handle_new_from_message_copy(ffi.NULL, buf, length[0])
+    handle = gribapi.lib.grib_handle_new_from_message_copy(
+        gribapi.get_context(context), buf, length[0]
+    )
     if handle == ffi.NULL:
         return None
     else:
-        return gribapi.put_handle(handle)
+        return gribapi.put_context_handle(handle, context)
 
 
 class StreamReader(ReaderBase):
     """Read messages from a stream (an object with a ``read`` method)"""
 
-    def __init__(self, stream):
-        if cstd is None:
+    def __init__(self, stream, context=None):
+        if get_cstd() is None:
             raise OSError("This feature is not supported on Windows")
-        super().__init__()
+        super().__init__(context)
         self.stream = stream
 
     def _next_handle(self):
-        return codes_new_from_stream(self.stream)
+        return codes_new_from_stream(self.stream, self.context)
@@ -0,0 +1,179 @@
+import os
+import sys
+
+import numpy as np
+
+import eccodes
+import gribapi
+from gribapi import ffi
+
+from .message import GRIBMessage
+from .reader import ReaderBase
+
+# The values are stored after the encoded message, aligned for float64
+_ALIGNMENT = 8
+
+# Segments detached while their values were still used, closed once they are not
+_closing = []
+
+# Names of the segments created by this process, tracked until they are unlinked
+_created = set()
+
+
+def _shared_memory():
+    # Imported on use, multiprocessing.shared_memory is new in Python 3.8
+    from multiprocessing import shared_memory
+
+    return shared_memory
+
+
+def _attach(name):
+    """Attach a segment without letting the resource tracker unlink it at exit"""
+    if sys.version_info >= (3, 13):
+        return _shared_memory().SharedMemory(name, track=False)
+    shm = _shared_memory().SharedMemory(name)
+    if os.name == "posix" and name not in _created:
+        from multiprocessing import resource_tracker
+
+        # The segment belongs to the process which created it
+        resource_tracker.unregister(shm._name, "shared_memory")
+    return shm
+
+
+def _close_segments(segments):
+    for shm in segments:
+        try:
+            shm.close()
+        except BufferError:
+            _closing.append(shm)
+
+
+class SharedMessage:
+    """A message placed in a shared memory segment by :func:`share`
+
+    Only the name and layout of the segment are pickled, so sending it to other
+    processes copies neither the message nor its values. The segment lives until
+    :meth:`unlink` is called, once the consumers have attached it."""
+
+    def __init__(self, name, size, values_offset=None, values_count=0):
+        self.name = name
+        self.size = size
+        self.values_offset = values_offset
+        self.values_count = values_count
+        self._shm = None
+
+    def __getstate__(self):
+        state = self.__dict__.copy()
+        state["_shm"] = None
+        return state
+
+    def __repr__(self):
+        return f"SharedMessage({self.name!r}, {self.size})"
+
+    def unlink(self):
+        """Free the segment, the processes that attached it keep their mapping"""
+        shm = self._shm or _shared_memory().SharedMemory(self.name)
+        self._shm = None
+        shm.close()
+        shm.unlink()
+        _created.discard(self.name)
+
+
+def share(message, values=False):
+    """Copy a message to a new shared memory segment
+
+    Parameters
+    ----------
+    message: GRIBMessage
+        The message to share.
+    values: bool
+        Also share the decoded values, so the consumers do not decode them."""
+    buffer = message.get_buffer()
+    values_offset, data, values_count = None, None, 0
+    size = len(buffer)
+    if values:
+        data = np.ascontiguousarray(message.data, dtype="float64").ravel()
+        values_offset = -(-size // _ALIGNMENT) * _ALIGNMENT
+        size = values_offset + data.nbytes
+        values_count = data.size
+    shm = _shared_memory().SharedMemory(create=True, size=size)
+    _created.add(shm.name)
+    shm.buf[: len(buffer)] = buffer
+    if data is not None:
+        shm.buf[values_offset:size] = data.view("uint8")
+    shared = SharedMessage(shm.name, len(buffer), values_offset, values_count)
+    shared._shm = shm
+    return shared
+
+
+class SharedValuesMessage(GRIBMessage):
+    """A message read with its values shared, which are kept with the message
+
+    The values are returned whatever the data cache, they cost no decoding."""
+
+    def __init__(self, handle, values):
+        super().__init__(handle)
+        self._shared_values = values
+
+    @property
+    def data(self):
+        return self._shared_values
+
+
+class SharedMemoryReader(ReaderBase):
+    """Read messages from shared memory segments, without copying them
+
+    The messages are decoded in place in the segments, and their values are
+    taken from the segments when they were shared with ``values=True``. The
+    messages are released and the segments detached by :meth:`close`, the
+    values stay valid as long as they are referenced."""
+
+    def __init__(self, shared_messages, context=None):
+        # The context bound when the reader is created is held by it and its messages
+        super().__init__(gribapi.resolve_context(context))
+        self._shared = iter(shared_messages)
+        self._current = None
+        self._segments = []
+        self._handles = []
+
+    def _next_handle(self):
+        shared = next(self._shared, None)
+        if shared is None:
+            return None
+        shm = _attach(shared.name)
+        data = ffi.from_buffer(shm.buf)
+        self._segments.append((shm, data))
+        h = gribapi.lib.grib_handle_new_from_message(
+            gribapi.get_context(self.context), data, shared.size
+        )
+        if h == ffi.NULL:
+            raise eccodes.InvalidGribError(f"No message in {shared!r}")
+        handle = eccodes.Handle(h, parent=self.context)
+        self._handles.append(handle)
+        self._current = (shared, shm)
+        return handle
+
+    def _new_message(self, handle):
+        shared, shm = self._current
+        if not shared.values_count:
+            return GRIBMessage(handle)
+        end = shared.values_offset + 8 * shared.values_count
+        # The mapping stays valid as long as the values, even once detached
+        values = np.frombuffer(shm.buf[shared.values_offset : end], "float64")
+        values.flags.writeable = False
+        return SharedValuesMessage(handle, values)
+
+    def close(self):
+        """Release the messages read and detach the segments"""
+        for handle in self._handles:
+            handle.release()
+        self._handles.clear()
+        self._current = None
+        for _, data in self._segments:
+            ffi.release(data)
+        segments = _closing[:] + [shm for shm, _ in self._segments]
+        del _closing[:], self._segments[:]
+        _close_segments(segments)
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
@@ -26,13 +26,19 @@ import typing as T
 import attr
 import numpy as np
 
-from . import eccodes
-
-eccodes_version = eccodes.codes_get_api_version()
+from . import cache, eccodes, table, tracing
 
 LOG = logging.getLogger(__name__)
 _MARKER = object()
 
+
+def __getattr__(name):
+    # The library is only opened when the version is asked for, not at import
+    if name == "eccodes_version":
+        return eccodes.codes_get_api_version()
+    raise AttributeError(f"module {__name__!r} has no attribute {name!r}")
+
+
 #
 # No explicit support for MULTI-FIELD at Message level.
 #
@@ -48,12 +54,19 @@ class Message(collections.abc.MutableMapping):
     errors = attr.attrib(
         default="warn", validator=attr.validators.in_(["ignore", "warn", "raise"])
     )
+    # The names of the keys, listed once and dropped when a key is set
+    _keys = attr.attrib(default=None, init=False, repr=False, eq=False)
 
     @classmethod
     def from_file(
         cls, file, offset=None, product_kind=eccodes.CODES_PRODUCT_ANY, **kwargs
     ):
         # type: (T.IO[bytes], int, int, T.Any) -> Message
+        handle_cache = cache.get_handle_cache()
+        path = getattr(file, "name", None)
+        if handle_cache is not None and offset is not None and isinstance(path, str):
+            handle = handle_cache.handle(path, offset, product_kind, file)
+            return cls(codes_id=eccodes.Handle(eccodes.codes_clone(handle)), **kwargs)
         field_in_message = 0
         if isinstance(offset, tuple):
             offset, field_in_message = offset
@@ -65,22 +78,39 @@ class Message(collections.abc.MutableMapping):
             codes_id = eccodes.codes_new_from_file(file, product_kind=product_kind)
         if codes_id is None:
             raise EOFError("End of file: %r" % file)
-        return cls(codes_id=codes_id, **kwargs)
+        return cls(codes_id=eccodes.Handle(codes_id), **kwargs)
 
     @classmethod
     def from_sample_name(
         cls, sample_name, product_kind=eccodes.CODES_PRODUCT_GRIB, **kwargs
     ):
         codes_id = eccodes.codes_new_from_samples(sample_name, product_kind)
-        return cls(codes_id=codes_id, **kwargs)
+        return cls(codes_id=eccodes.Handle(codes_id), **kwargs)
 
     @classmethod
     def from_message(cls, message, **kwargs):
         codes_id = eccodes.codes_clone(message.codes_id)
-        return cls(codes_id=codes_id, **kwargs)
+        return cls(codes_id=eccodes.Handle(codes_id), **kwargs)
 
     def __del__(self):
-        eccodes.codes_release(self.codes_id)
+        # Raising is not possible here, the release waits for the keys iterators
+        if isinstance(self.codes_id, eccodes.Handle):
+            self.codes_id.release(strict=False)
+        else:
+            eccodes.codes_release(self.codes_id)
+
+    def __reduce_ex__(self, protocol):
+        # type: (int) -> T.Tuple[T.Any, ...]
+        # Pickle the encoded message, out-of-band with protocol 5, and the attributes
+        buffer = eccodes.codes_get_message(self.codes_id)
+        if protocol >= 5:
+            buffer = pickle.PickleBuffer(buffer)
+        kwargs = {
+            a.name: getattr(self, a.name)
+            for a in attr.fields(type(self))
+            if a.init and a.name != "codes_id"
+        }
+        return message_from_buffer, (type(self), buffer, kwargs)
 
     def message_get(self, item, key_type=None, default=_MARKER):
         # type: (str, type, T.Any) -> T.Any
@@ -102,6 +132,8 @@ class Message(collections.abc.MutableMapping):
 
     def message_set(self, item, value):
         # type: (str, T.Any) -> None
+        # Setting a key may add or remove others, e.g. gridType
+        self._keys = None
         set_array = isinstance(value, T.Sequence) and not isinstance(
             value, (str, bytes)
         )
@@ -147,19 +179,35 @@ class Message(collections.abc.MutableMapping):
     def __delitem__(self, item):
         raise NotImplementedError
 
+    def message_keys(self):
+        # type: () -> T.Tuple[str, ...]
+        """Return the names of the keys, listed by the library only once per handle."""
+        if self._keys is None:
+            self._keys = tuple(self.list_keys())
+        return self._keys
+
+    def list_keys(self):
+        # type: () -> T.Iterable[str]
+        return self.message_grib_keys()
+
     def __iter__(self):
-        # type: () -> T.Generator[str, None, None]
-        for key in self.message_grib_keys():
-            yield key
+        # type: () -> T.Iterator[str]
+        return iter(self.message_keys())
 
     def __len__(self):
         # type: () -> int
-        return sum(1 for _ in self)
+        return len(self.message_keys())
 
     def write(self, file):
         eccodes.codes_write(self.codes_id, file)
 
 
+def message_from_buffer(cls, buffer, kwargs):
+    # type: (T.Type[Message], T.Any, T.Dict[str, T.Any]) -> Message
+    codes_id = eccodes.codes_new_from_message(buffer)
+    return cls(codes_id=eccodes.Handle(codes_id), **kwargs)
+
+
 @attr.attrs()
 class ComputedKeysMessage(Message):
     """Extension of Message class for adding computed keys."""
@@ -178,14 +226,10 @@ class ComputedKeysMessage(Message):
         else:
             return super(ComputedKeysMessage, self).__getitem__(item)
 
-    def __iter__(self):
-        seen = set()
-        for key in super(ComputedKeysMessage, self).__iter__():
-            yield key
-            seen.add(key)
-        for key in self.computed_keys:
-            if key not in seen:
-                yield key
+    def list_keys(self):
+        keys = list(super(ComputedKeysMessage, self).list_keys())
+        seen = set(keys)
+        return keys + [key for key in self.computed_keys if key not in seen]
 
     def __setitem__(self, item, value):
         if item in self.computed_keys:
@@ -262,6 +306,14 @@ class FileIndex(collections.abc.Mapping):
 
     @classmethod
     def from_filestream(cls, filestream, index_keys):
+        with tracing.span("eccodes.index", path=filestream.path) as span:
+            self = cls._from_filestream(filestream, index_keys)
+            if span is not tracing.NO_SPAN:
+                span.set_attribute("messages", sum(len(o) for _, o in self.offsets))
+        return self
+
+    @classmethod
+    def _from_filestream(cls, filestream, index_keys):
         offsets = collections.OrderedDict()
         count_offsets = {}  # type: T.Dict[int, int]
         for message in filestream:
@@ -294,6 +346,12 @@ class FileIndex(collections.abc.Mapping):
         with io.open(indexpath, "rb") as file:
             return pickle.load(file)
 
+    @staticmethod
+    def format_indexpath(filestream, index_keys, indexpath):
+        # type: (FileStream, T.List[str], str) -> str
+        hash = hashlib.md5(repr(index_keys).encode("utf-8")).hexdigest()
+        return indexpath.format(path=filestream.path, hash=hash, short_hash=hash[:5])
+
     @classmethod
     def from_indexpath_or_filestream(
         cls, filestream, index_keys, indexpath="{path}.{short_hash}.idx", log=LOG
@@ -304,10 +362,7 @@ class FileIndex(collections.abc.Mapping):
         if not indexpath:
             return cls.from_filestream(filestream, index_keys)
 
-        hash = hashlib.md5(repr(index_keys).encode("utf-8")).hexdigest()
-        indexpath = indexpath.format(
-            path=filestream.path, hash=hash, short_hash=hash[:5]
-        )
+        indexpath = cls.format_indexpath(filestream, index_keys, indexpath)
         try:
             with compat_create_exclusive(indexpath) as new_index_file:
                 self = cls.from_filestream(filestream, index_keys)
@@ -391,3 +446,245 @@ class FileIndex(collections.abc.Mapping):
         with open(self.filestream.path) as file:
             first_offset = self.offsets[0][1][0]
             return self.filestream.message_from_file(file, offset=first_offset)
+
+    def to_table(self, backend=None):
+        # type: (T.Optional[str]) -> T.Any
+        """
+        Return a table of the header values, offset and field in the message of each
+        message, "undef" values are missing.
+
+        It is a pyarrow Table when pyarrow is installed, a numpy record array otherwise,
+        or as selected by ``backend``, "arrow" or "numpy".
+        """
+        names = self.index_keys + ["offset", "field_in_message"]
+        columns = collections.OrderedDict((name, []) for name in names)
+        for header_values, offsets in self.offsets:
+            values = [
+                None if v == "undef" else list(v) if isinstance(v, tuple) else v
+                for v in header_values
+            ]
+            for offset in offsets:
+                for key, value in zip(self.index_keys, values):
+                    columns[key].append(value)
+                if isinstance(offset, tuple):
+                    offset, field_in_message = offset
+                else:
+                    field_in_message = 0
+                columns["offset"].append(offset)
+                columns["field_in_message"].append(field_in_message)
+        return table.make_table(columns, backend)
+
+    def to_array(self, dims, field_shape=None):
+        # type: (T.List[str], T.Optional[T.Tuple[int, ...]]) -> FieldsArray
+        """
+        Return a lazy array of the values of the messages along the index keys ``dims``.
+
+        The shape is the number of header values of each key followed by the shape of
+        the fields, (Nj, Ni) on regular grids and the number of points otherwise.
+        There must be at most one message for each combination of the values of ``dims``,
+        select the other keys with ``subindex`` first. The missing fields are NaN.
+        """
+        unknown = [dim for dim in dims if dim not in self.index_keys]
+        if unknown:
+            raise ValueError("dims not in the index keys: %r" % unknown)
+        if not self.offsets:
+            raise ValueError("no message in the index, check the subindex selection")
+        key_positions = [self.index_keys.index(dim) for dim in dims]
+        coords = collections.OrderedDict((dim, self[dim]) for dim in dims)
+        lookups = [{value: i for i, value in enumerate(coords[dim])} for dim in dims]
+        fields = {}  # type: T.Dict[T.Tuple[int, ...], T.Any]
+        for header_values, offsets in self.offsets:
+            position = tuple(
+                lookup[header_values[key_position]]
+                for lookup, key_position in zip(lookups, key_positions)
+            )
+            if len(offsets) > 1 or position in fields:
+                raise ValueError(
+                    "several messages for %r, restrict the index with subindex"
+                    % dict(zip(dims, (header_values[p] for p in key_positions)))
+                )
+            fields[position] = offsets[0]
+        if field_shape is None:
+            with open(self.filestream.path, "rb") as file:
+                message = self.filestream.message_from_file(
+                    file, offset=self.offsets[0][1][0]
+                )
+                field_shape = get_field_shape(message)
+        return FieldsArray(
+            filestream=self.filestream,
+            coords=coords,
+            field_shape=tuple(field_shape),
+            fields=fields,
+        )
+
+
+def load_field(path, offset, shape, product_kind=eccodes.CODES_PRODUCT_ANY):
+    # type: (str, T.Any, T.Tuple[int, ...], int) -> np.ndarray
+    """Return the values of the message at offset in a file, NaN if offset is None"""
+    result = np.full(shape, np.nan)
+    handle_cache = cache.get_handle_cache()
+    if offset is not None and handle_cache is not None:
+        result.reshape(-1)[:] = handle_cache.values(path, offset, product_kind)
+    elif offset is not None:
+        with open(path, "rb") as file:
+            message = Message.from_file(file, offset, product_kind)
+            eccodes.codes_get_values(message.codes_id, out=result.reshape(-1))
+    return result
+
+
+def get_field_shape(message):
+    # type: (Message) -> T.Tuple[int, ...]
+    size = message.message_get("numberOfDataPoints", int)
+    ni = message.message_get("Ni", int, default=None)
+    nj = message.message_get("Nj", int, default=None)
+    if ni and nj and ni * nj == size:
+        return (nj, ni)
+    return (size,)
+
+
+@attr.attrs()
+class FieldsArray(object):
+    """
+    Lazy N-dimensional array of the values of the messages of a FileIndex.
+
+    Indexing reads and decodes only the messages of the selected fields, in the
+    order of the file, into the preallocated result.
+    """
+
+    filestream = attr.attrib(type=FileStream)
+    coords = attr.attrib(type=T.Dict[str, list])
+    field_shape = attr.attrib(type=T.Tuple[int, ...])
+    # {position along the dims: offset of the message}
+    fields = attr.attrib(repr=False, type=T.Dict[T.Tuple[int, ...], T.Any])
+    dtype = np.dtype("float64")
+
+    @property
+    def dims(self):
+        return list(self.coords)
+
+    @property
+    def shape(self):
+        return tuple(len(values) for values in self.coords.values()) + self.field_shape
+
+    @property
+    def ndim(self):
+        return len(self.shape)
+
+    @property
+    def size(self):
+        return int(np.prod(self.shape))
+
+    @property
+    def nbytes(self):
+        return self.size * self.dtype.itemsize
+
+    def __len__(self):
+        return self.shape[0]
+
+    def _expand_key(self, key):
+        if not isinstance(key, tuple):
+            key = (key,)
+        if any(k is Ellipsis for k in key):
+            i = [k is Ellipsis for k in key].index(True)
+            key = key[:i] + (slice(None),) * (self.ndim - len(key) + 1) + key[i + 1 :]
+        if len(key) > self.ndim:
+            raise IndexError("too many indices for a %d-dimensional array" % self.ndim)
+        return key + (slice(None),) * (self.ndim - len(key))
+
+    def __getitem__(self, key):
+        key = self._expand_key(key)
+        header_key, field_key = key[: len(self.coords)], key[len(self.coords) :]
+        selections = []
+        kept_shape = []
+        for k, values in zip(header_key, self.coords.values()):
+            selected = np.arange(len(values))[k]
+            if np.ndim(selected) == 0:
+                selections.append([int(selected)])
+            else:
+                selections.append(selected.tolist())
+                kept_shape.append(len(selected))
+        full_field = all(isinstance(k, slice) and k == slice(None) for k in field_key)
+        # the shape of the selection of a field, without allocating a field
+        field_selection = np.broadcast_to(np.empty((), self.dtype), self.field_shape)
+        selected_field_shape = field_selection[field_key].shape
+
+        result_shape = tuple(len(s) for s in selections)
+        result = np.full(result_shape + selected_field_shape, np.nan, self.dtype)
+        reads = []
+        for out_position in np.ndindex(*result_shape):
+            position = tuple(s[i] for s, i in zip(selections, out_position))
+            if position in self.fields:
+                reads.append((self.fields[position], out_position))
+        reads.sort(key=lambda read: read[0] if isinstance(read[0], int) else read[0][0])
+
+        handle_cache = cache.get_handle_cache()
+        path, product_kind = self.filestream.path, self.filestream.product_kind
+        with open(path, "rb") as file:
+            for offset, out_position in reads:
+                if handle_cache is not None:
+                    values = handle_cache.values(path, offset, product_kind, file)
+                    result[out_position] = values.reshape(self.field_shape)[field_key]
+                    continue
+                message = self.filestream.message_from_file(file, offset=offset)
+                if full_field:
+                    eccodes.codes_get_values(
+                        message.codes_id, out=result[out_position].reshape(-1)
+                    )
+                else:
+                    values = eccodes.codes_get_values(message.codes_id)
+                    result[out_position] = values.reshape(self.field_shape)[field_key]
+        return result.reshape(tuple(kept_shape) + selected_field_shape)
+
+    def __array__(self, dtype=None):
+        return np.asarray(self[...], dtype=dtype)
+
+    @property
+    def chunks(self):
+        """The chunks in the format of dask, one message per chunk"""
+        header_chunks = tuple((1,) * len(values) for values in self.coords.values())
+        return header_chunks + tuple((size,) for size in self.field_shape)
+
+    @property
+    def numblocks(self):
+        return tuple(len(chunks) for chunks in self.chunks)
+
+    def chunk_loader(self, block_id):
+        # type: (T.Tuple[int, ...]) -> T.Tuple[T.Any, ...]
+        """
+        Return the task (function, arguments...) loading a chunk.
+
+        The task only holds the path and offset of the message, so it can be
+        sent to another process and run there without the index.
+        """
+        position = tuple(block_id[: len(self.coords)])
+        shape = (1,) * len(self.coords) + self.field_shape
+        offset = self.fields.get(position)
+        return (
+            load_field,
+            self.filestream.path,
+            offset,
+            shape,
+            self.filestream.product_kind,
+        )
+
+    def load_chunk(self, block_id):
+        # type: (T.Tuple[int, ...]) -> np.ndarray
+        function, *args = self.chunk_loader(block_id)
+        return function(*args)
+
+    def dask_graph(self, name):
+        # type: (str) -> T.Dict[T.Tuple[T.Any, ...], T.Tuple[T.Any, ...]]
+        """Return the tasks loading each chunk, keyed by (name, block indices...)"""
+        return {
+            (name,) + block_id: self.chunk_loader(block_id)
+            for block_id in np.ndindex(*self.numblocks)
+        }
+
+    def to_dask(self, name=None):
+        """Return a dask array of the fields, dask must be installed"""
+        import dask.array
+
+        if name is None:
+            token = repr((self.filestream.path, self.dims, sorted(self.fields.items())))
+            name = "eccodes-" + hashlib.md5(token.encode("utf-8")).hexdigest()
+        return dask.array.Array(self.dask_graph(name), name, self.chunks, self.dtype)
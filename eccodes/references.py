@@ -0,0 +1,113 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Reference sets of the byte ranges and header keys of the messages of files,
+for readers fetching single messages by range, e.g. from object stores.
+
+A reference set is a dictionary::
+
+    {"version": 1, "path": path, "columns": ["offset", "length", key, ...],
+     "refs": [[offset, length, value, ...], ...]}
+
+saved as compact JSON, or as a numpy ``.npz`` file with a typed array per column
+and a mask of the missing values of the columns with None, the columns of mixed
+types are stored as JSON text so they load without pickle.
+"""
+
+import json
+
+import numpy as np
+
+from . import eccodes, table
+
+VERSION = 1
+
+
+def scan_references(path, keys=(), product_kind=eccodes.CODES_PRODUCT_GRIB):
+    """Return the reference set of the messages of a file, see codes_scan_references"""
+    columns = ["offset", "length"] + list(keys)
+    refs = [
+        [reference[column] for column in columns]
+        for reference in eccodes.codes_scan_references(path, keys, product_kind)
+    ]
+    return {"version": VERSION, "path": path, "columns": columns, "refs": refs}
+
+
+def dump(references, file, format="json"):
+    """Write a reference set to a binary file object, as "json" or "npz" """
+    if format == "json":
+        text = json.dumps(references, separators=(",", ":"))
+        file.write(text.encode("utf-8"))
+    elif format == "npz":
+        columns = list(zip(*references["refs"])) or [[]] * len(references["columns"])
+        arrays, json_columns = {}, []
+        for i, values in enumerate(columns):
+            missing = np.array([v is None for v in values], dtype="bool")
+            column = table.numpy_column([v for v in values if v is not None])
+            if column.dtype == object:
+                column = np.array([json.dumps(v) for v in values], dtype="str")
+                json_columns.append(i)
+            elif missing.any():
+                # Typed as the values present, the placeholders are masked
+                present = column
+                column = np.zeros(len(values), dtype=present.dtype)
+                column[~missing] = present
+            if missing.any():
+                arrays["missing_%d" % i] = missing
+            arrays["column_%d" % i] = column
+        np.savez(
+            file,
+            version=references["version"],
+            path=references["path"],
+            columns=np.array(references["columns"], dtype="str"),
+            json_columns=np.array(json_columns, dtype="int64"),
+            **arrays,
+        )
+    else:
+        raise ValueError("format must be json or npz, not %r" % format)
+
+
+def load(file):
+    """Read a reference set written by dump in any format from a binary file object"""
+    start = file.read(2)
+    file.seek(-len(start), 1)
+    if start != b"PK":
+        return json.loads(file.read().decode("utf-8"))
+    with np.load(file) as npz:
+        columns = [str(column) for column in npz["columns"]]
+        values = [npz["column_%d" % i].tolist() for i in range(len(columns))]
+        for i in npz["json_columns"].tolist():
+            values[i] = [json.loads(v) for v in values[i]]
+        for i in range(len(columns)):
+            if "missing_%d" % i in npz:
+                missing = npz["missing_%d" % i].tolist()
+                values[i] = [None if m else v for v, m in zip(values[i], missing)]
+        version, path = int(npz["version"]), str(npz["path"])
+    return {
+        "version": version,
+        "path": path,
+        "columns": columns,
+        "refs": [list(row) for row in zip(*values)],
+    }
+
+
+def read_message(references, index, opener=open):
+    """
+    Return the handle of a message of a reference set, reading only its bytes.
+
+    opener(path, "rb") opens the file of the set, e.g. ``fsspec.open`` for remote files.
+    """
+    offset, length = references["refs"][index][:2]
+    with opener(references["path"], "rb") as file:
+        file.seek(offset)
+        message = file.read(length)
+    return eccodes.Handle(eccodes.codes_new_from_message(message))
@@ -0,0 +1,89 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Columnar tables of the header keys, offsets and lengths of the messages.
+
+The tables are pyarrow Tables when pyarrow is installed, which export through
+the Arrow C data interface and write to Parquet, or numpy record arrays.
+"""
+
+import collections
+
+import numpy as np
+
+from . import eccodes
+
+BACKENDS = ["arrow", "numpy"]
+
+
+def scan_columns(
+    path,
+    keys,
+    product_kind=eccodes.CODES_PRODUCT_GRIB,
+    context=None,
+    start=0,
+    stop=None,
+):
+    """Return the offset, length and header keys of the messages of a file by column
+
+    See codes_scan_references, the keys not found in a message are None."""
+    names = ["offset", "length"] + list(keys)
+    columns = collections.OrderedDict((name, []) for name in names)
+    references = eccodes.codes_scan_references(
+        path, keys, product_kind, context, start, stop
+    )
+    for reference in references:
+        for name, column in columns.items():
+            column.append(reference[name])
+    return columns
+
+
+def numpy_column(values):
+    """Return the values as a typed numpy array, None is NaN or an empty string"""
+    present = [value for value in values if value is not None]
+    if all(isinstance(value, (int, np.integer)) for value in present):
+        if len(present) == len(values):
+            return np.array(values, dtype="int64")
+        return np.array([np.nan if v is None else v for v in values], dtype="float64")
+    if all(isinstance(value, (int, float, np.number)) for value in present):
+        return np.array([np.nan if v is None else v for v in values], dtype="float64")
+    if all(isinstance(value, str) for value in present):
+        return np.array(["" if v is None else v for v in values], dtype="str")
+    column = np.empty(len(values), dtype=object)
+    column[:] = values
+    return column
+
+
+def make_table(columns, backend=None):
+    """
+    Return a table of columns, a mapping of names to lists of values.
+
+    backend is "arrow" for a pyarrow Table, "numpy" for a numpy record array,
+    or None for a pyarrow Table when pyarrow is installed.
+    """
+    if backend not in BACKENDS + [None]:
+        raise ValueError("backend must be one of %r" % BACKENDS)
+    if backend != "numpy":
+        try:
+            import pyarrow
+        except ImportError:
+            if backend == "arrow":
+                raise
+        else:
+            return pyarrow.table(
+                collections.OrderedDict(
+                    (name, pyarrow.array(values)) for name, values in columns.items()
+                )
+            )
+    return np.rec.fromarrays(
+        [numpy_column(values) for values in columns.values()], names=list(columns)
+    )
@@ -0,0 +1,109 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Spans around the reading, decoding, encoding and writing of the messages.
+
+A tracer is any object with a ``start_as_current_span(name, attributes=None)``
+method returning a context manager of a span with a ``set_attribute(key, value)``
+method, like the tracers of OpenTelemetry. Without a tracer the spans cost a
+global lookup.
+"""
+
+import contextlib
+import time
+
+from . import eccodes
+
+_tracer = None
+
+
+class _NoSpan:
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        return False
+
+    def set_attribute(self, key, value):
+        pass
+
+
+NO_SPAN = _NoSpan()
+
+
+def set_tracer(tracer):
+    """Install the tracer of all the threads, None to stop tracing, return the previous one"""
+    global _tracer
+    previous, _tracer = _tracer, tracer
+    return previous
+
+
+def get_tracer():
+    return _tracer
+
+
+def span(name, **attributes):
+    """Return the context manager of a span of the tracer, or a span doing nothing"""
+    if _tracer is None:
+        return NO_SPAN
+    return _tracer.start_as_current_span(name, attributes=attributes)
+
+
+def set_message_attributes(span, handle):
+    """Add the offset, size and edition of a message to a span, if it is traced"""
+    if span is not NO_SPAN:
+        span.set_attribute("offset", eccodes.codes_get_message_offset(handle))
+        span.set_attribute("size", eccodes.codes_get_message_size(handle))
+        span.set_attribute("edition", eccodes.codes_get_long(handle, "edition"))
+
+
+class Span:
+    def __init__(self, name, attributes):
+        self.name = name
+        self.attributes = attributes
+        self.start_time = None
+        self.end_time = None
+
+    def set_attribute(self, key, value):
+        self.attributes[key] = value
+
+    @property
+    def duration(self):
+        """Duration of the span in seconds"""
+        return self.end_time - self.start_time
+
+    def __repr__(self):
+        return f"Span({self.name!r}, {self.attributes!r})"
+
+
+class MemoryTracer:
+    """Keep the finished spans in a list, for tests and local measurements"""
+
+    def __init__(self):
+        self.spans = []
+
+    @contextlib.contextmanager
+    def start_as_current_span(self, name, attributes=None):
+        span = Span(name, dict(attributes or {}))
+        span.start_time = time.perf_counter()
+        try:
+            yield span
+        finally:
+            span.end_time = time.perf_counter()
+            self.spans.append(span)
+
+    def durations(self, name):
+        """Return the durations in seconds of the spans of the given name"""
+        return [span.duration for span in self.spans if span.name == name]
+
+    def clear(self):
+        self.spans.clear()
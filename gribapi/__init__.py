@@ -10,15 +10,13 @@
 #
 #
 
+from .bindings import min_recommended_version_int  # noqa
+from .bindings import min_recommended_version_str  # noqa
 from .gribapi import *  # noqa
-from .gribapi import __version__, lib
+from .gribapi import grib_get_api_version, lib  # noqa
 
-# The minimum recommended version for the ecCodes package
-min_recommended_version_str = "2.21.0"
-min_recommended_version_int = 22100
 
-if lib.grib_get_api_version() < min_recommended_version_int:
-    print(
-        "Warning: ecCodes %s or higher is recommended. You are running version %s"
-        % (min_recommended_version_str, __version__)
-    )
+def __getattr__(name):
+    if name == "__version__":
+        return grib_get_api_version()
+    raise AttributeError(f"module {__name__!r} has no attribute {name!r}")
@@ -16,31 +16,202 @@
 
 from __future__ import absolute_import, division, print_function, unicode_literals
 
+import hashlib
 import logging
+import os
 import pkgutil
-
-import cffi
+import threading
+import time
 
 __version__ = "1.5.0"
 
 LOG = logging.getLogger(__name__)
 
-try:
-    import ecmwflibs as findlibs
-except ImportError:
-    import findlibs
-
-library_path = findlibs.find("eccodes")
-if library_path is None:
-    raise RuntimeError("Cannot find the ecCodes library")
-
 # default encoding for ecCodes strings
 ENC = "ascii"
 
-ffi = cffi.FFI()
-CDEF = pkgutil.get_data(__name__, "grib_api.h")
-CDEF += pkgutil.get_data(__name__, "eccodes.h")
-ffi.cdef(CDEF.decode("utf-8").replace("\r", "\n"))
+# The minimum recommended version for the ecCodes package
+min_recommended_version_str = "2.21.0"
+min_recommended_version_int = 22100
+
+
+def read_headers():
+    headers = pkgutil.get_data(__name__, "grib_api.h")
+    return headers + pkgutil.get_data(__name__, "eccodes.h")
+
+
+def read_cdef():
+    return read_headers().decode("utf-8").replace("\r", "\n")
+
+
+def cdef_hash(headers):
+    return hashlib.sha1(headers).hexdigest()
+
+
+def load_precompiled():
+    """Return the module of the declarations parsed at build time, if they are current"""
+    try:
+        from . import _bindings_abi
+    except ImportError:
+        return None
+    # The hash of the headers they were parsed from is saved by builder.build_abi
+    if getattr(_bindings_abi, "CDEF_HASH", None) != cdef_hash(read_headers()):
+        return None
+    return _bindings_abi
+
+
+_precompiled = load_precompiled()
+if _precompiled is not None:
+    ffi = _precompiled.ffi
+else:
+    import cffi
+
+    ffi = cffi.FFI()
+    ffi.cdef(read_cdef())
+
+
+def find_library():
+    try:
+        import ecmwflibs as findlibs
+    except ImportError:
+        import findlibs
+
+    library_path = findlibs.find("eccodes")
+    if library_path is None:
+        raise RuntimeError("Cannot find the ecCodes library")
+    return library_path
+
+
+# Bytes moved by a call, for the functions where it is known from the arguments
+CALL_BYTES = {
+    "grib_get_message": lambda args: args[2][0],
+    "grib_get_string": lambda args: args[3][0],
+    "grib_get_double_array": lambda args: args[3][0] * ffi.sizeof("double"),
+    "grib_get_long_array": lambda args: args[3][0] * ffi.sizeof("long"),
+    "grib_get_double_elements": lambda args: args[3] * ffi.sizeof("double"),
+    "grib_set_double_array": lambda args: args[3] * ffi.sizeof("double"),
+    "grib_set_long_array": lambda args: args[3] * ffi.sizeof("long"),
+    "grib_handle_new_from_message": lambda args: args[2],
+    "grib_handle_new_from_message_copy": lambda args: args[2],
+    "wmo_read_any_from_stream_malloc": lambda args: args[2][0],
+    "wmo_read_any_from_stream": lambda args: args[3][0],
+}
+
+
+def message_bytes(lib, h):
+    if h == ffi.NULL:
+        return 0
+    size = ffi.new("size_t*")
+    lib.grib_get_message_size(h, size)
+    return size[0]
+
+
+# Bytes moved by a call, for the functions where it is only known from the result
+RESULT_BYTES = {
+    "codes_handle_new_from_file": message_bytes,
+    "grib_new_from_file": message_bytes,
+}
+
+
+class Library:
+    """
+    The ecCodes library, found and opened on first use.
+
+    Each attribute is copied to the instance the first time it is looked up,
+    so the following lookups cost the same as on the cffi library object.
+    While the statistics are on, the functions are copied wrapped in a
+    counter of the calls, of their time and of the bytes they move.
+    """
+
+    _lock = threading.Lock()
+    _path = None
+    _lib = None
+    # {function name: [calls, seconds, bytes]}, or None when not counting
+    _stats = {} if os.environ.get("ECCODES_PYTHON_STATS", "0") == "1" else None
+    _stats_lock = threading.Lock()
+
+    def _open(self):
+        with self._lock:
+            if self._lib is None:
+                path = find_library()
+                lib = ffi.dlopen(path)
+                version = lib.grib_get_api_version()
+                if version < min_recommended_version_int:
+                    print(
+                        "Warning: ecCodes %s or higher is recommended. You are running version %s"
+                        % (
+                            min_recommended_version_str,
+                            "%d.%d.%d"
+                            % (version // 10000, version // 100 % 100, version % 100),
+                        )
+                    )
+                Library._path = path
+                Library._lib = lib
+        return self._lib
+
+    def __getattr__(self, name):
+        if name.startswith("__"):
+            raise AttributeError(name)
+        value = getattr(self._lib or self._open(), name)
+        if self._stats is not None and callable(value):
+            value = self._counted(name, value)
+        setattr(self, name, value)
+        return value
+
+    def __dir__(self):
+        return dir(self._lib or self._open())
+
+    def _counted(self, name, function):
+        call_bytes = CALL_BYTES.get(name)
+        result_bytes = RESULT_BYTES.get(name)
+
+        def counted(*args):
+            start = time.perf_counter()
+            result = function(*args)
+            elapsed = time.perf_counter() - start
+            nbytes = call_bytes(args) if call_bytes else 0
+            if result_bytes:
+                # Looked up on the library so that it is not counted itself
+                nbytes = result_bytes(self._lib, result)
+            with self._stats_lock:
+                stats = Library._stats
+                if stats is not None:
+                    record = stats.setdefault(name, [0, 0.0, 0])
+                    record[0] += 1
+                    record[1] += elapsed
+                    record[2] += nbytes
+            return result
+
+        counted.__name__ = name
+        return counted
+
+    def set_stats(self, flag):
+        """Turn on/off the statistics, the cached attributes are looked up again"""
+        with self._stats_lock:
+            if bool(flag) != (Library._stats is not None):
+                Library._stats = {} if flag else None
+                vars(self).clear()
+
+    def get_stats(self):
+        with self._stats_lock:
+            return {
+                name: {"calls": calls, "time": seconds, "bytes": nbytes}
+                for name, (calls, seconds, nbytes) in sorted(
+                    (Library._stats or {}).items()
+                )
+            }
+
+    def reset_stats(self):
+        with self._stats_lock:
+            if Library._stats is not None:
+                Library._stats.clear()
+
+
+lib = Library()
 
 
-lib = ffi.dlopen(library_path)
+def __getattr__(name):
+    if name == "library_path":
+        lib._open()
+        return Library._path
+    raise AttributeError(f"module {__name__!r} has no attribute {name!r}")
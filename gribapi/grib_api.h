@@ -72,7 +72,11 @@ void grib_index_delete(grib_index* index);
 
 int grib_count_in_file(grib_context* c, FILE* f,int* n);
 grib_handle* grib_handle_new_from_file(grib_context* c, FILE* f, int* error);
+grib_handle* grib_new_from_file(grib_context* c, FILE* f, int headers_only, int* error);
 grib_handle* grib_handle_new_from_message_copy(grib_context* c, const void* data, size_t data_len);
+grib_handle* grib_handle_new_from_message(grib_context* c, const void* data, size_t data_len);
+void* wmo_read_any_from_stream_malloc(void* stream_data, long (*stream_proc)(void*, void* buffer, long len), size_t* size, int* err);
+int wmo_read_any_from_stream(void* stream_data, long (*stream_proc)(void*, void* buffer, long len), void* buffer, size_t* len);
 grib_handle* grib_handle_new_from_samples (grib_context* c, const char* sample_name);
 grib_handle* grib_handle_clone(const grib_handle* h)                 ;
 int grib_handle_delete(grib_handle* h);
@@ -122,6 +126,15 @@ int grib_set_string_array(grib_handle* h, const char *key, const char **vals, si
 
 void grib_dump_content(const grib_handle* h, FILE* out, const char* mode, unsigned long option_flags, void* arg);
 grib_context* grib_context_get_default(void);
+grib_context* grib_context_new(grib_context* parent);
+
+typedef void* (*grib_malloc_proc)(const grib_context* c, size_t length);
+typedef void  (*grib_free_proc)(const grib_context* c, void* data);
+typedef void* (*grib_realloc_proc)(const grib_context* c, void* data, size_t length);
+void grib_context_set_memory_proc(grib_context* c, grib_malloc_proc p_malloc, grib_free_proc p_free, grib_realloc_proc p_realloc);
+void grib_context_set_buffer_memory_proc(grib_context* c, grib_malloc_proc p_malloc, grib_free_proc p_free, grib_realloc_proc p_realloc);
+void* grib_context_realloc(const grib_context* c, void* p, size_t size);
+void grib_context_free(const grib_context* c, void* p);
 void grib_context_delete(grib_context* c);
 
 void grib_gts_header_on(grib_context* c) ;
@@ -27,16 +27,19 @@ Numpy is a package used for scientific computing in Python and an efficient cont
 
 import os
 import sys
-from functools import wraps
+import threading
+import types
+from functools import lru_cache, wraps
 
 import numpy as np
 
 from gribapi.errors import GribInternalError
 
-from . import errors
+from . import bindings, errors, registry
 from .bindings import ENC
 from .bindings import __version__ as bindings_version  # noqa
-from .bindings import ffi, lib, library_path
+from .bindings import ffi, lib
+from .memory import Allocator, ArenaAllocator  # noqa
 
 try:
     type(file)
@@ -74,10 +77,135 @@ GRIB_NEAREST_SAME_GRID = 1 << 0
 GRIB_NEAREST_SAME_DATA = 1 << 1
 GRIB_NEAREST_SAME_POINT = 1 << 2
 
+# Number of key names kept encoded by _encode_key, the least recently used go first
+KEY_CACHE_SIZE = int(os.environ.get("ECCODES_PYTHON_KEY_CACHE_SIZE", "4096"))
+
+
+@lru_cache(maxsize=KEY_CACHE_SIZE)
+def _encode_key(key):
+    # The cache keeps the char[] alive: the same key name is encoded only once
+    # and passed to C without allocating a new bytes object at every call
+    return ffi.new("char[]", key.encode(ENC))
+
+
+def key_cache_info():
+    """
+    @brief Return the hits, misses and size of the encoded key names cache.
+    """
+    return _encode_key.cache_info()
+
+
+def key_cache_clear():
+    """
+    @brief Empty the encoded key names cache.
+    """
+    _encode_key.cache_clear()
+
+
+def set_stats(flag):
+    """
+    @brief Turn on/off the statistics of the calls to the C library.
+
+    The initial state is taken from the environment variable ECCODES_PYTHON_STATS.
+    While off, the functions of the library are called directly and cost nothing more.
+
+    @param flag       True to count the calls, their time and the bytes they move
+    """
+    lib.set_stats(flag)
+
+
+def get_stats():
+    """
+    @brief Return the statistics of the calls to the C library since the last reset.
+
+    @return dict of function name to a dict with the number of "calls", their "time"
+            in seconds, and the "bytes" moved, for the functions where it is known
+    """
+    return lib.get_stats()
+
+
+def reset_stats():
+    """
+    @brief Reset the statistics of the calls to the C library.
+    """
+    lib.reset_stats()
+
+
+def live_handles():
+    """
+    @brief Return the number of objects of each kind created and not yet released.
+
+    The kinds are the names of the classes owning them: Handle, Index, KeysIterator,
+    Nearest, ... whether they were returned as typed objects or legacy ids.
+
+    The size of the messages is recorded when they are created, the library is
+    not asked for it as they may be released by other threads meanwhile.
+
+    @return dict of kind to a dict with the "count" of objects and their total
+            size in "bytes", the size of the encoded messages and 0 for the others
+    """
+    return {
+        kind: {"count": count, "bytes": nbytes}
+        for kind, (count, nbytes) in registry.totals().items()
+    }
+
+
+def set_debug_handles(flag):
+    """
+    @brief Turn on/off the recording of the stack where each object is created.
+
+    The initial state is taken from the environment variable ECCODES_PYTHON_DEBUG_HANDLES.
+    When on, the objects not released at exit are logged with their creation stack.
+    """
+    registry.set_debug(flag)
+
+
+def leaked_handles_report():
+    """
+    @brief Return the description of the live objects with their creation stack.
+    """
+    return registry.leaks_report()
+
+
 # ECC-1029: Disable function-arguments type-checking unless
 # environment variable is defined and equal to 1
 enable_type_checks = os.environ.get("ECCODES_PYTHON_ENABLE_TYPE_CHECKS") == "1"
 
+# Fast mode: the hot-path functions are never type-checked, even when the
+# type-checks are enabled, unless environment variable is defined and equal to 0
+enable_fast_path = os.environ.get("ECCODES_PYTHON_FAST_PATH", "1") != "0"
+
+# Functions called once or more per key and per message
+HOT_PATH = frozenset(
+    [
+        "grib_get",
+        "grib_get_array",
+        "grib_get_double",
+        "grib_get_double_array",
+        "grib_get_long",
+        "grib_get_long_array",
+        "grib_get_native_type",
+        "grib_get_size",
+        "grib_get_string",
+        "grib_get_string_array",
+        "grib_get_string_length",
+        "grib_get_values",
+        "grib_is_defined",
+        "grib_is_missing",
+        "grib_keys_iterator_get_name",
+        "grib_keys_iterator_next",
+        "codes_bufr_keys_iterator_get_name",
+        "codes_bufr_keys_iterator_next",
+    ]
+)
+
+# name -> (type-checked function, plain function) for all decorated functions
+_checked_functions = {}
+
+
+def _is_checked(name):
+    return enable_type_checks and not (enable_fast_path and name in HOT_PATH)
+
 
 # Function-arguments type-checking decorator
 # inspired from http://code.activestate.com/recipes/454322-type-checking-decorator/
@@ -89,33 +217,74 @@ def require(**_params_):
     """
 
     def check_types(_func_, _params_=_params_):
-        if not enable_type_checks:
-            return _func_
+        # Resolve the position of the checked arguments once, not at every call
+        arg_names = _func_.__code__.co_varnames[: _func_.__code__.co_argcount]
+        checks = []
+        for name, allowed_types in _params_.items():
+            if isinstance(allowed_types, type):
+                allowed_types = (allowed_types,)
+            checks.append((name, arg_names.index(name), tuple(allowed_types)))
 
         @wraps(_func_)
         # The wrapper function. Replaces the target function and receives its args
         def modified(*args, **kw):
-            arg_names = _func_.__code__.co_varnames
-            # argnames, varargs, kwargs, defaults = inspect.getargspec(_func_)
-            kw.update(zip(arg_names, args))
-            for name, allowed_types in _params_.items():
-                param = kw[name]
-                if isinstance(allowed_types, type):
-                    allowed_types = (allowed_types,)
-                assert any(
-                    [isinstance(param, type1) for type1 in allowed_types]
+            nargs = len(args)
+            for name, position, allowed_types in checks:
+                if position < nargs:
+                    param = args[position]
+                elif name in kw:
+                    param = kw[name]
+                else:
+                    continue
+                assert isinstance(
+                    param, allowed_types
                 ), "Parameter '%s' should be of type %s (instead of %s)" % (
                     name,
                     " or ".join([t.__name__ for t in allowed_types]),
                     type(param).__name__,
                 )
-            return _func_(**kw)
+            return _func_(*args, **kw)
 
-        return modified
+        _checked_functions[_func_.__name__] = (modified, _func_)
+        return modified if _is_checked(_func_.__name__) else _func_
 
     return check_types
 
 
+def set_type_checks(flag, fast_path=True):
+    """
+    @brief Turn on/off the type-checking of the function arguments.
+
+    The initial state is taken from the environment variables
+    ECCODES_PYTHON_ENABLE_TYPE_CHECKS and ECCODES_PYTHON_FAST_PATH.
+    The functions are rebound in the gribapi and eccodes modules: references
+    obtained before the call, e.g. with "from eccodes import codes_get",
+    keep their previous behaviour.
+
+    @param flag       True to check the types of the arguments
+    @param fast_path  True to never check the functions of the hot path (see HOT_PATH)
+    """
+    global enable_type_checks, enable_fast_path
+    enable_type_checks = bool(flag)
+    enable_fast_path = bool(fast_path)
+
+    rebind = {}
+    for name, (checked, plain) in _checked_functions.items():
+        if _is_checked(name):
+            rebind[plain] = checked
+        else:
+            rebind[checked] = plain
+
+    for module_name in ("gribapi.gribapi", "gribapi", "eccodes.eccodes", "eccodes"):
+        module = sys.modules.get(module_name)
+        if module is None:
+            continue
+        namespace = vars(module)
+        for name, value in list(namespace.items()):
+            if isinstance(value, types.FunctionType) and value in rebind:
+                namespace[name] = rebind[value]
+
+
 # @cond
 class Bunch(dict):
     """
@@ -152,10 +321,39 @@ class Bunch(dict):
 # @endcond
 
 
+class _Scratch(threading.local):
+    """
+    Out-parameters of the scalar getters, allocated once per thread and
+    reused by all the calls. A slot must be read back right after the C call
+    that fills it, before any other call can reuse it.
+    """
+
+    def __init__(self):
+        self.err_p = ffi.new("int *")
+        self.int_p = ffi.new("int *")
+        self.long_p = ffi.new("long *")
+        self.double_p = ffi.new("double *")
+        self.size_p = ffi.new("size_t *")
+        self.chars = ffi.new("char[]", 256)
+
+    def char_buffer(self, length):
+        # Grown to the longest string read so far, never shrunk
+        if len(self.chars) < length:
+            self.chars = ffi.new("char[]", length)
+        return self.chars
+
+
+_scratch = _Scratch()
+
+# Guards the counts of children, updated by the finalizers in any thread, and
+# reentrant as a finalizer may run in the thread holding it
+_children_lock = threading.RLock()
+
+
 def err_last(func):
     @wraps(func)
     def wrapper(*args):
-        err = ffi.new("int *")
+        err = _scratch.err_p
         args += (err,)
         retval = func(*args)
         return err[0], retval
@@ -163,57 +361,304 @@ def err_last(func):
     return wrapper
 
 
+class CodesObject(int):
+    """
+    Base class for the objects owning a pointer returned by the C API.
+
+    Instances are ints equal to the legacy id of the object, so they are accepted
+    wherever an id is, but they carry the cdata pointer: no cast is needed on
+    each call and the C object is deleted exactly once, either by @ref release
+    or when the instance is garbage collected. Any use after release raises.
+
+    The objects created from another one (e.g. the keys iterators of a message,
+    or the messages of a context) are counted by it, and it cannot be released
+    while they are alive, since the C library would leave them dangling.
+    """
+
+    _ctype = None
+    _destructor = None
+    _error = errors.GribInternalError
+
+    def __new__(cls, cdata, parent=None):
+        if type(cdata) is cls:
+            return cdata
+        if isinstance(cdata, int):
+            cdata = ffi.cast(cls._ctype, cdata)
+        if cdata == ffi.NULL:
+            raise cls._error(f"{cls.__name__}: Bad ID {cdata}")
+        self = int.__new__(cls, int(ffi.cast("size_t", cdata)))
+        kind, address = cls.__name__, int(self)
+        parents = parent if isinstance(parent, tuple) else (parent,)
+        parents = tuple(p for p in parents if isinstance(p, CodesObject))
+
+        # The object may reference its parent (e.g. a keys iterator and its
+        # message), so the parent must outlive it
+        def destructor(cdata, delete=getattr(lib, cls._destructor), parent=parent):
+            registry.remove(kind, address)
+            delete(cdata)
+            _count_children(parents, -1)
+
+        self._children = 0
+        self._parents = parents
+        _count_children(parents, 1)
+        self._cdata = ffi.gc(cdata, destructor)
+        registry.add(kind, address, cls._size(cdata))
+        return self
+
+    @staticmethod
+    def _size(cdata):
+        """Size in bytes of the C object, recorded by the registry"""
+        return 0
+
+    @property
+    def cdata(self):
+        """The cdata pointer of the C object"""
+        if self._cdata is None:
+            raise self._error(f"{type(self).__name__} {int(self)} has been released")
+        return self._cdata
+
+    @property
+    def released(self):
+        return self._cdata is None
+
+    def release(self, strict=True):
+        """
+        Delete the C object now. Further calls have no effect.
+
+        Raises if objects created from this one are still alive, unless strict is
+        False: the object is then released and its C object deleted once they are
+        all gone, for the callers which cannot raise such as __del__ methods.
+        """
+        with _children_lock:
+            if self._cdata is None:
+                return
+            if self._children and strict:
+                raise self._error(
+                    f"{type(self).__name__} {int(self):#x} cannot be released while"
+                    f" {self._children} objects created from it are alive"
+                )
+            cdata, self._cdata = self._cdata, None
+            if self._children:
+                # The children keep this object, so its finalizer, alive
+                self._deferred = cdata
+                return
+        ffi.release(cdata)
+
+    def detach(self):
+        """Give up the ownership of the C object and return its legacy id"""
+        cdata, self._cdata = self.cdata, None
+        ffi.gc(cdata, None)
+        _count_children(self._parents, -1)
+        return int(self)
+
+    def __repr__(self):
+        state = " released" if self._cdata is None else ""
+        return f"<{type(self).__name__} {int(self):#x}{state}>"
+
+
+def _count_children(parents, n):
+    with _children_lock:
+        for p in parents:
+            p._children += n
+
+
+class Handle(CodesObject):
+    """A message loaded in memory"""
+
+    _ctype = "grib_handle*"
+    _destructor = "grib_handle_delete"
+    _error = errors.InvalidGribError
+
+    @staticmethod
+    def _size(cdata):
+        return message_size(cdata)
+
+
+class MultiHandle(CodesObject):
+    """A multi-field GRIB message"""
+
+    _ctype = "grib_multi_handle*"
+    _destructor = "grib_multi_handle_delete"
+    _error = errors.InvalidGribError
+
+
+class Index(CodesObject):
+    """An index created from files"""
+
+    _ctype = "grib_index*"
+    _destructor = "grib_index_delete"
+    _error = errors.InvalidIndexError
+
+
+class GeoIterator(CodesObject):
+    """A geoiterator over the points of a GRIB message"""
+
+    _ctype = "grib_iterator*"
+    _destructor = "grib_iterator_delete"
+    _error = errors.InvalidIteratorError
+
+
+class KeysIterator(CodesObject):
+    """An iterator over the keys of a message"""
+
+    _ctype = "grib_keys_iterator*"
+    _destructor = "grib_keys_iterator_delete"
+    _error = errors.InvalidKeysIteratorError
+
+
+class BufrKeysIterator(CodesObject):
+    """An iterator over the keys of a BUFR message"""
+
+    _ctype = "bufr_keys_iterator*"
+    _destructor = "codes_bufr_keys_iterator_delete"
+    _error = errors.InvalidKeysIteratorError
+
+
+class Context(CodesObject):
+    """
+    A context independent of the default one, with its own caches.
+
+    The messages created with a context keep it alive. Use it as a context
+    manager to bind it to the current thread for the duration of a block.
+    """
+
+    _ctype = "grib_context*"
+    _destructor = "grib_context_delete"
+
+    def __enter__(self):
+        # The previous bindings are kept per thread, so the same context can be
+        # entered by several threads and nested in one thread
+        if not hasattr(_bound_context, "previous"):
+            _bound_context.previous = []
+        _bound_context.previous.append(grib_context_bind(self))
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        grib_context_bind(_bound_context.previous.pop())
+
+
+# The context bound to each thread, used when no context is given explicitly
+_bound_context = threading.local()
+
+
+class Nearest(CodesObject):
+    """A nearest neighbour finder bound to a GRIB message"""
+
+    _ctype = "grib_nearest*"
+    _destructor = "grib_nearest_delete"
+    _error = errors.InvalidNearestError
+
+
 def get_handle(msgid):
+    if type(msgid) is Handle:
+        return msgid.cdata
     h = ffi.cast("grib_handle*", msgid)
     if h == ffi.NULL:
         raise errors.InvalidGribError(f"get_handle: Bad message ID {msgid}")
     return h
 
 
+def message_size(h):
+    """Size of the encoded message, 0 when it cannot be computed"""
+    size_p = _scratch.size_p
+    if lib.grib_get_message_size(h, size_p):
+        return 0
+    return size_p[0]
+
+
 def put_handle(handle):
     if handle == ffi.NULL:
         raise errors.InvalidGribError(f"put_handle: Bad message ID {handle}")
-    return int(ffi.cast("size_t", handle))
+    return registry.put("Handle", handle, message_size(handle))
+
+
+def resolve_context(contextid=None):
+    """Return the context given, or the one bound to the thread, or None"""
+    if contextid is None:
+        return getattr(_bound_context, "context", None)
+    return contextid
+
+
+def get_context(contextid=None):
+    contextid = resolve_context(contextid)
+    if contextid is None:
+        return ffi.NULL
+    if type(contextid) is Context:
+        return contextid.cdata
+    return ffi.cast("grib_context*", contextid)
+
+
+def get_context_or_default(contextid=None):
+    c = get_context(contextid)
+    if c == ffi.NULL:
+        return lib.grib_context_get_default()
+    return c
+
+
+def put_context_handle(handle, contextid=None):
+    """Return the id of a new handle, owning it if it was created with a Context"""
+    contextid = resolve_context(contextid)
+    if type(contextid) is Context:
+        return Handle(handle, parent=contextid)
+    return put_handle(handle)
 
 
 def get_multi_handle(msgid):
+    if type(msgid) is MultiHandle:
+        return msgid.cdata
     return ffi.cast("grib_multi_handle*", msgid)
 
 
 def put_multi_handle(handle):
-    return int(ffi.cast("size_t", handle))
+    return registry.put("MultiHandle", handle)
 
 
 def get_index(indexid):
+    if type(indexid) is Index:
+        return indexid.cdata
     return ffi.cast("grib_index*", indexid)
 
 
 def put_index(indexh):
-    return int(ffi.cast("size_t", indexh))
+    return registry.put("Index", indexh)
 
 
 def get_iterator(iterid):
+    if type(iterid) is GeoIterator:
+        return iterid.cdata
     return ffi.cast("grib_iterator*", iterid)
 
 
 def put_iterator(iterh):
-    return int(ffi.cast("size_t", iterh))
+    return registry.put("GeoIterator", iterh)
 
 
 def get_grib_keys_iterator(iterid):
+    if type(iterid) is KeysIterator:
+        return iterid.cdata
     return ffi.cast("grib_keys_iterator*", iterid)
 
 
 def put_grib_keys_iterator(iterh):
-    return int(ffi.cast("size_t", iterh))
+    if iterh == ffi.NULL:
+        raise errors.InvalidKeysIteratorError(
+            f"put_grib_keys_iterator: Bad iterator ID {iterh}"
+        )
+    return registry.put("KeysIterator", iterh)
 
 
 def get_bufr_keys_iterator(iterid):
+    if type(iterid) is BufrKeysIterator:
+        return iterid.cdata
     return ffi.cast("bufr_keys_iterator*", iterid)
 
 
 def put_bufr_keys_iterator(iterh):
-    return int(ffi.cast("size_t", iterh))
+    if iterh == ffi.NULL:
+        raise errors.InvalidKeysIteratorError(
+            f"put_bufr_keys_iterator: Bad iterator ID {iterh}"
+        )
+    return registry.put("BufrKeysIterator", iterh)
 
 
 # @cond
@@ -234,7 +679,7 @@ def GRIB_CHECK(errid):
 
 
 @require(fileobj=file)
-def gts_new_from_file(fileobj, headers_only=False):
+def gts_new_from_file(fileobj, headers_only=False, context=None):
     """
     @brief Load in memory a GTS message from a file.
 
@@ -242,13 +687,14 @@ def gts_new_from_file(fileobj, headers_only=False):
     until @ref codes_release is called.\n
 
     @param fileobj        python file object
-    @param headers_only   whether or not to load the message with the headers only
+    @param headers_only   ignored, only GRIB messages can be loaded with the headers only
+    @param context        context used to decode the message, default is the one bound to the thread
     @return               id of the GTS loaded in memory or None
     @exception CodesInternalError
     """
 
     err, h = err_last(lib.codes_handle_new_from_file)(
-        ffi.NULL, fileobj, CODES_PRODUCT_GTS
+        get_context(context), fileobj, CODES_PRODUCT_GTS
     )
     if err:
         if err == lib.GRIB_END_OF_FILE:
@@ -259,11 +705,11 @@ def gts_new_from_file(fileobj, headers_only=False):
     if h == ffi.NULL:
         return None
     else:
-        return put_handle(h)
+        return put_context_handle(h, context)
 
 
 @require(fileobj=file)
-def metar_new_from_file(fileobj, headers_only=False):
+def metar_new_from_file(fileobj, headers_only=False, context=None):
     """
     @brief Load in memory a METAR message from a file.
 
@@ -271,13 +717,14 @@ def metar_new_from_file(fileobj, headers_only=False):
     until @ref codes_release is called.\n
 
     @param fileobj        python file object
-    @param headers_only   whether or not to load the message with the headers only
+    @param headers_only   ignored, only GRIB messages can be loaded with the headers only
+    @param context        context used to decode the message, default is the one bound to the thread
     @return               id of the METAR loaded in memory or None
     @exception CodesInternalError
     """
 
     err, h = err_last(lib.codes_handle_new_from_file)(
-        ffi.NULL, fileobj, CODES_PRODUCT_METAR
+        get_context(context), fileobj, CODES_PRODUCT_METAR
     )
     if err:
         if err == lib.GRIB_END_OF_FILE:
@@ -288,11 +735,11 @@ def metar_new_from_file(fileobj, headers_only=False):
     if h == ffi.NULL:
         return None
     else:
-        return put_handle(h)
+        return put_context_handle(h, context)
 
 
 @require(fileobj=file, product_kind=int)
-def codes_new_from_file(fileobj, product_kind, headers_only=False):
+def codes_new_from_file(fileobj, product_kind, headers_only=False, context=None):
     """
     @brief Load in memory a message from a file for a given product.
 
@@ -303,25 +750,26 @@ def codes_new_from_file(fileobj, product_kind, headers_only=False):
 
     @param fileobj        python file object
     @param product_kind   one of CODES_PRODUCT_GRIB, CODES_PRODUCT_BUFR, CODES_PRODUCT_METAR or CODES_PRODUCT_GTS
-    @param headers_only   whether or not to load the message with the headers only
+    @param headers_only   whether or not to load the GRIB messages with the headers only
+    @param context        context used to decode the message, default is the one bound to the thread
     @return               id of the message loaded in memory or None
     @exception CodesInternalError
     """
     if product_kind == CODES_PRODUCT_GRIB:
-        return grib_new_from_file(fileobj, headers_only)
+        return grib_new_from_file(fileobj, headers_only, context)
     if product_kind == CODES_PRODUCT_BUFR:
-        return bufr_new_from_file(fileobj, headers_only)
+        return bufr_new_from_file(fileobj, headers_only, context)
     if product_kind == CODES_PRODUCT_METAR:
-        return metar_new_from_file(fileobj, headers_only)
+        return metar_new_from_file(fileobj, headers_only, context)
     if product_kind == CODES_PRODUCT_GTS:
-        return gts_new_from_file(fileobj, headers_only)
+        return gts_new_from_file(fileobj, headers_only, context)
     if product_kind == CODES_PRODUCT_ANY:
-        return any_new_from_file(fileobj, headers_only)
+        return any_new_from_file(fileobj, headers_only, context)
     raise ValueError("Invalid product kind %d" % product_kind)
 
 
 @require(fileobj=file)
-def any_new_from_file(fileobj, headers_only=False):
+def any_new_from_file(fileobj, headers_only=False, context=None):
     """
     @brief Load in memory a message from a file.
 
@@ -331,12 +779,13 @@ def any_new_from_file(fileobj, headers_only=False):
     \b Examples: \ref grib_get_keys.py "grib_get_keys.py"
 
     @param fileobj        python file object
-    @param headers_only   whether or not to load the message with the headers only
+    @param headers_only   ignored, only GRIB messages can be loaded with the headers only
+    @param context        context used to decode the message, default is the one bound to the thread
     @return               id of the message loaded in memory or None
     @exception CodesInternalError
     """
     err, h = err_last(lib.codes_handle_new_from_file)(
-        ffi.NULL, fileobj, CODES_PRODUCT_ANY
+        get_context(context), fileobj, CODES_PRODUCT_ANY
     )
     if err:
         if err == lib.GRIB_END_OF_FILE:
@@ -347,11 +796,11 @@ def any_new_from_file(fileobj, headers_only=False):
     if h == ffi.NULL:
         return None
     else:
-        return put_handle(h)
+        return put_context_handle(h, context)
 
 
 @require(fileobj=file)
-def bufr_new_from_file(fileobj, headers_only=False):
+def bufr_new_from_file(fileobj, headers_only=False, context=None):
     """
     @brief Load in memory a BUFR message from a file.
 
@@ -361,12 +810,13 @@ def bufr_new_from_file(fileobj, headers_only=False):
     \b Examples: \ref bufr_get_keys.py "bufr_get_keys.py"
 
     @param fileobj        python file object
-    @param headers_only   whether or not to load the message with the headers only
+    @param headers_only   ignored, only GRIB messages can be loaded with the headers only
+    @param context        context used to decode the message, default is the one bound to the thread
     @return               id of the BUFR loaded in memory or None
     @exception CodesInternalError
     """
     err, h = err_last(lib.codes_handle_new_from_file)(
-        ffi.NULL, fileobj, CODES_PRODUCT_BUFR
+        get_context(context), fileobj, CODES_PRODUCT_BUFR
     )
     if err:
         if err == lib.GRIB_END_OF_FILE:
@@ -377,11 +827,11 @@ def bufr_new_from_file(fileobj, headers_only=False):
     if h == ffi.NULL:
         return None
     else:
-        return put_handle(h)
+        return put_context_handle(h, context)
 
 
 @require(fileobj=file)
-def grib_new_from_file(fileobj, headers_only=False):
+def grib_new_from_file(fileobj, headers_only=False, context=None):
     """
     @brief Load in memory a GRIB message from a file.
 
@@ -399,13 +849,18 @@ def grib_new_from_file(fileobj, headers_only=False):
 
     @param fileobj        python file object
     @param headers_only   whether or not to load the message with the headers only
+    @param context        context used to decode the message, default is the one bound to the thread
     @return               id of the grib loaded in memory or None
     @exception CodesInternalError
     """
 
-    err, h = err_last(lib.codes_handle_new_from_file)(
-        ffi.NULL, fileobj, CODES_PRODUCT_GRIB
-    )
+    if headers_only:
+        # The data sections are skipped in the file, not read
+        err, h = err_last(lib.grib_new_from_file)(get_context(context), fileobj, 1)
+    else:
+        err, h = err_last(lib.codes_handle_new_from_file)(
+            get_context(context), fileobj, CODES_PRODUCT_GRIB
+        )
     if err:
         if err == lib.GRIB_END_OF_FILE:
             return None
@@ -415,7 +870,7 @@ def grib_new_from_file(fileobj, headers_only=False):
     if h == ffi.NULL:
         return None
     else:
-        return put_handle(h)
+        return put_context_handle(h, context)
 
 
 @require(fileobj=file)
@@ -435,31 +890,34 @@ def grib_count_in_file(fileobj):
     return num_p[0]
 
 
-def grib_multi_support_on():
+def grib_multi_support_on(context=None):
     """
     @brief Turn on the support for multiple fields in a single GRIB message.
 
+    @param context   context to change, default is the one bound to the thread or the default one
     @exception CodesInternalError
     """
-    lib.grib_multi_support_on(ffi.NULL)
+    lib.grib_multi_support_on(get_context_or_default(context))
 
 
-def grib_multi_support_off():
+def grib_multi_support_off(context=None):
     """
     @brief Turn off the support for multiple fields in a single GRIB message.
 
+    @param context   context to change, default is the one bound to the thread or the default one
     @exception CodesInternalError
     """
-    lib.grib_multi_support_off(ffi.NULL)
+    lib.grib_multi_support_off(get_context_or_default(context))
 
 
 @require(fileobj=file)
-def grib_multi_support_reset_file(fileobj):
+def grib_multi_support_reset_file(fileobj, context=None):
     """
     @brief Reset file handle in multiple field support mode
+
+    @param context   context to reset, default is the one bound to the thread or the default one
     """
-    context = lib.grib_context_get_default()
-    lib.grib_multi_support_reset_file(context, fileobj)
+    lib.grib_multi_support_reset_file(get_context_or_default(context), fileobj)
 
 
 @require(msgid=int)
@@ -472,7 +930,11 @@ def grib_release(msgid):
     @param msgid      id of the message loaded in memory
     @exception CodesInternalError
     """
+    if type(msgid) is Handle:
+        msgid.release()
+        return
     h = get_handle(msgid)
+    registry.remove("Handle", int(msgid))
     GRIB_CHECK(lib.grib_handle_delete(h))
 
 
@@ -489,9 +951,10 @@ def grib_get_string(msgid, key):
     length = grib_get_string_length(msgid, key)
 
     h = get_handle(msgid)
-    values = ffi.new("char[]", length)
-    length_p = ffi.new("size_t *", length)
-    err = lib.grib_get_string(h, key.encode(ENC), values, length_p)
+    values = _scratch.char_buffer(length)
+    length_p = _scratch.size_p
+    length_p[0] = length
+    err = lib.grib_get_string(h, _encode_key(key), values, length_p)
     GRIB_CHECK(err)
     return _decode_bytes(values, length_p[0])
 
@@ -509,25 +972,27 @@ def grib_set_string(msgid, key, value):
     h = get_handle(msgid)
     bvalue = value.encode(ENC)
     length_p = ffi.new("size_t *", len(bvalue))
-    GRIB_CHECK(lib.grib_set_string(h, key.encode(ENC), bvalue, length_p))
+    GRIB_CHECK(lib.grib_set_string(h, _encode_key(key), bvalue, length_p))
 
 
-def grib_gribex_mode_on():
+def grib_gribex_mode_on(context=None):
     """
     @brief Turn on the compatibility mode with GRIBEX.
 
+    @param context   context to change, default is the one bound to the thread or the default one
     @exception CodesInternalError
     """
-    lib.grib_gribex_mode_on(ffi.NULL)
+    lib.grib_gribex_mode_on(get_context_or_default(context))
 
 
-def grib_gribex_mode_off():
+def grib_gribex_mode_off(context=None):
     """
     @brief Turn off the compatibility mode with GRIBEX.
 
+    @param context   context to change, default is the one bound to the thread or the default one
     @exception CodesInternalError
     """
-    lib.grib_gribex_mode_off(ffi.NULL)
+    lib.grib_gribex_mode_off(get_context_or_default(context))
 
 
 @require(msgid=int, fileobj=file)
@@ -594,8 +1059,8 @@ def grib_get_size(msgid, key):
     @exception CodesInternalError
     """
     h = get_handle(msgid)
-    size_p = ffi.new("size_t*")
-    err = lib.grib_get_size(h, key.encode(ENC), size_p)
+    size_p = _scratch.size_p
+    err = lib.grib_get_size(h, _encode_key(key), size_p)
     GRIB_CHECK(err)
     return size_p[0]
 
@@ -610,8 +1075,8 @@ def grib_get_string_length(msgid, key):
     @exception CodesInternalError
     """
     h = get_handle(msgid)
-    size = ffi.new("size_t *")
-    err = lib.grib_get_length(h, key.encode(ENC), size)
+    size = _scratch.size_p
+    err = lib.grib_get_length(h, _encode_key(key), size)
     GRIB_CHECK(err)
     return size[0]
 
@@ -724,6 +1189,8 @@ def grib_iterator_new(gribid, mode):
     h = get_handle(gribid)
     err, iterid = err_last(lib.grib_iterator_new)(h, mode)
     GRIB_CHECK(err)
+    if type(gribid) is Handle:
+        return GeoIterator(iterid, gribid)
     return put_iterator(iterid)
 
 
@@ -737,7 +1204,11 @@ def grib_iterator_delete(iterid):
     @param iterid  geoiterator id
     @exception CodesInternalError
     """
+    if type(iterid) is GeoIterator:
+        iterid.release()
+        return
     ih = get_iterator(iterid)
+    registry.remove("GeoIterator", int(iterid))
     GRIB_CHECK(lib.grib_iterator_delete(ih))
 
 
@@ -792,6 +1263,8 @@ def grib_keys_iterator_new(msgid, namespace=None):
     h = get_handle(msgid)
     bnamespace = ffi.NULL if namespace is None else namespace.encode(ENC)
     iterid = lib.grib_keys_iterator_new(h, 0, bnamespace)
+    if type(msgid) is Handle:
+        return KeysIterator(iterid, msgid)
     return put_grib_keys_iterator(iterid)
 
 
@@ -822,7 +1295,11 @@ def grib_keys_iterator_delete(iterid):
     @param iterid      keys iterator id created with @ref grib_keys_iterator_new
     @exception CodesInternalError
     """
+    if type(iterid) is KeysIterator:
+        iterid.release()
+        return
     kih = get_grib_keys_iterator(iterid)
+    registry.remove("KeysIterator", int(iterid))
     lib.grib_keys_iterator_delete(kih)
 
 
@@ -876,6 +1353,8 @@ def codes_bufr_keys_iterator_new(bufrid):
         raise errors.InvalidKeysIteratorError(
             f"BUFR keys iterator failed bufrid={bufrid}"
         )
+    if type(bufrid) is Handle:
+        return BufrKeysIterator(bki, bufrid)
     return put_bufr_keys_iterator(bki)
 
 
@@ -906,7 +1385,11 @@ def codes_bufr_keys_iterator_delete(iterid):
     @param iterid      keys iterator id created with @ref codes_bufr_keys_iterator_new
     @exception CodesInternalError
     """
+    if type(iterid) is BufrKeysIterator:
+        iterid.release()
+        return
     bki = get_bufr_keys_iterator(iterid)
+    registry.remove("BufrKeysIterator", int(iterid))
     GRIB_CHECK(lib.codes_bufr_keys_iterator_delete(bki))
 
 
@@ -949,8 +1432,8 @@ def grib_get_long(msgid, key):
     @exception CodesInternalError
     """
     h = get_handle(msgid)
-    value_p = ffi.new("long*")
-    err = lib.grib_get_long(h, key.encode(ENC), value_p)
+    value_p = _scratch.long_p
+    err = lib.grib_get_long(h, _encode_key(key), value_p)
     GRIB_CHECK(err)
     return value_p[0]
 
@@ -966,8 +1449,8 @@ def grib_get_double(msgid, key):
     @exception CodesInternalError
     """
     h = get_handle(msgid)
-    value_p = ffi.new("double*")
-    err = lib.grib_get_double(h, key.encode(ENC), value_p)
+    value_p = _scratch.double_p
+    err = lib.grib_get_double(h, _encode_key(key), value_p)
     GRIB_CHECK(err)
     return value_p[0]
 
@@ -994,7 +1477,7 @@ def grib_set_long(msgid, key, value):
         raise ValueError("Value too large")
 
     h = get_handle(msgid)
-    GRIB_CHECK(lib.grib_set_long(h, key.encode(ENC), value))
+    GRIB_CHECK(lib.grib_set_long(h, _encode_key(key), value))
 
 
 @require(msgid=int, key=str, value=(int, float, np.float16, np.float32, str))
@@ -1015,11 +1498,11 @@ def grib_set_double(msgid, key, value):
     except (ValueError, TypeError):
         raise TypeError("Invalid type")
     h = get_handle(msgid)
-    GRIB_CHECK(lib.grib_set_double(h, key.encode(ENC), value))
+    GRIB_CHECK(lib.grib_set_double(h, _encode_key(key), value))
 
 
 @require(samplename=str, product_kind=int)
-def codes_new_from_samples(samplename, product_kind):
+def codes_new_from_samples(samplename, product_kind, context=None):
     """
     @brief Create a new valid message from a sample for a given product.
 
@@ -1031,20 +1514,21 @@ def codes_new_from_samples(samplename, product_kind):
 
     @param samplename     name of the sample to be used
     @param product_kind   CODES_PRODUCT_GRIB or CODES_PRODUCT_BUFR
+    @param context        context used to load the sample, default is the one bound to the thread
     @return               id of the message loaded in memory
     @exception CodesInternalError
     """
     if product_kind == CODES_PRODUCT_GRIB:
-        return grib_new_from_samples(samplename)
+        return grib_new_from_samples(samplename, context)
     if product_kind == CODES_PRODUCT_BUFR:
-        return codes_bufr_new_from_samples(samplename)
+        return codes_bufr_new_from_samples(samplename, context)
     if product_kind == CODES_PRODUCT_ANY:
-        return codes_any_new_from_samples(samplename)
+        return codes_any_new_from_samples(samplename, context)
     raise ValueError("Invalid product kind %d" % product_kind)
 
 
 @require(samplename=str)
-def grib_new_from_samples(samplename):
+def grib_new_from_samples(samplename, context=None):
     """
     @brief Create a new valid GRIB message from a sample.
 
@@ -1055,17 +1539,18 @@ def grib_new_from_samples(samplename):
     \b Examples: \ref grib_samples.py "grib_samples.py"
 
     @param samplename   name of the sample to be used
+    @param context      context used to load the sample, default is the one bound to the thread
     @return             id of the message loaded in memory
     @exception CodesInternalError
     """
-    h = lib.grib_handle_new_from_samples(ffi.NULL, samplename.encode(ENC))
+    h = lib.grib_handle_new_from_samples(get_context(context), samplename.encode(ENC))
     if h == ffi.NULL:
         raise errors.FileNotFoundError(f"grib_new_from_samples failed: {samplename}")
-    return put_handle(h)
+    return put_context_handle(h, context)
 
 
 @require(samplename=str)
-def codes_bufr_new_from_samples(samplename):
+def codes_bufr_new_from_samples(samplename, context=None):
     """
     @brief Create a new valid BUFR message from a sample.
 
@@ -1076,17 +1561,20 @@ def codes_bufr_new_from_samples(samplename):
     \b Examples: \ref bufr_copy_data.py "bufr_copy_data.py"
 
     @param samplename   name of the BUFR sample to be used
+    @param context      context used to load the sample, default is the one bound to the thread
     @return             id of the message loaded in memory
     @exception CodesInternalError
     """
-    h = lib.codes_bufr_handle_new_from_samples(ffi.NULL, samplename.encode(ENC))
+    h = lib.codes_bufr_handle_new_from_samples(
+        get_context(context), samplename.encode(ENC)
+    )
     if h == ffi.NULL:
         raise errors.FileNotFoundError(f"bufr_new_from_samples failed: {samplename}")
-    return put_handle(h)
+    return put_context_handle(h, context)
 
 
 @require(samplename=str)
-def codes_any_new_from_samples(samplename):
+def codes_any_new_from_samples(samplename, context=None):
     """
     @brief Create a new valid message from a sample.
 
@@ -1095,13 +1583,14 @@ def codes_any_new_from_samples(samplename):
     To know where the samples directory is run the codes_info tool.\n
 
     @param samplename   name of the sample to be used
+    @param context      context used to load the sample, default is the one bound to the thread
     @return             id of the message loaded in memory
     @exception CodesInternalError
     """
-    h = lib.codes_handle_new_from_samples(ffi.NULL, samplename.encode(ENC))
+    h = lib.codes_handle_new_from_samples(get_context(context), samplename.encode(ENC))
     if h == ffi.NULL:
         raise errors.FileNotFoundError(f"any_new_from_samples failed: {samplename}")
-    return put_handle(h)
+    return put_context_handle(h, context)
 
 
 @require(msgid_src=int, msgid_dst=int)
@@ -1142,6 +1631,10 @@ def grib_clone(msgid_src):
     h_dest = lib.grib_handle_clone(h_src)
     if h_dest == ffi.NULL:
         raise errors.InvalidGribError("clone failed")
+    if type(msgid_src) is Handle:
+        # The clone is created on the context of the source, which it keeps alive
+        contexts = tuple(p for p in msgid_src._parents if type(p) is Context)
+        return Handle(h_dest, parent=contexts)
     return put_handle(h_dest)
 
 
@@ -1174,25 +1667,33 @@ def grib_set_double_array(msgid, key, inarray):
     else:
         a = inarray
 
-    GRIB_CHECK(lib.grib_set_double_array(h, key.encode(ENC), a, length))
+    GRIB_CHECK(lib.grib_set_double_array(h, _encode_key(key), a, length))
 
 
 @require(msgid=int, key=str)
-def grib_get_double_array(msgid, key):
+def grib_get_double_array(msgid, key, out=None):
     """
     @brief Get the value of the key as a NumPy array of doubles.
 
     @param msgid   id of the message loaded in memory
     @param key     key name
-    @return        numpy.ndarray
+    @param out     optional C-contiguous float64 array of the size of the key, decoded into
+    @return        numpy.ndarray, out if given
     @exception CodesInternalError
     """
     h = get_handle(msgid)
     nval = grib_get_size(msgid, key)
     length_p = ffi.new("size_t*", nval)
-    arr = np.empty((nval,), dtype="float64")
+    if out is None:
+        arr = np.empty((nval,), dtype="float64")
+    elif out.dtype != np.float64 or out.size != nval or not out.flags["C_CONTIGUOUS"]:
+        raise ValueError(
+            f"grib_get_double_array: out must be a contiguous float64 array of size {nval}"
+        )
+    else:
+        arr = out
     vals_p = ffi.cast("double *", arr.ctypes.data)
-    err = lib.grib_get_double_array(h, key.encode(ENC), vals_p, length_p)
+    err = lib.grib_get_double_array(h, _encode_key(key), vals_p, length_p)
     GRIB_CHECK(err)
     return arr
 
@@ -1226,7 +1727,7 @@ def grib_get_string_array(msgid, key):
     values_keepalive = [ffi.new("char[]", length) for _ in range(size)]
     values = ffi.new("char*[]", values_keepalive)
     size_p = ffi.new("size_t *", size)
-    err = lib.grib_get_string_array(h, key.encode(ENC), values, size_p)
+    err = lib.grib_get_string_array(h, _encode_key(key), values, size_p)
     GRIB_CHECK(err)
     return [_decode_bytes(values[i]) for i in range(size_p[0])]
 
@@ -1250,7 +1751,7 @@ def grib_set_string_array(msgid, key, inarray):
     # See https://cffi.readthedocs.io/en/release-1.3/using.html
     values_keepalive = [ffi.new("char[]", s.encode(ENC)) for s in inarray]
     values_p = ffi.new("const char *[]", values_keepalive)
-    GRIB_CHECK(lib.grib_set_string_array(h, key.encode(ENC), values_p, size))
+    GRIB_CHECK(lib.grib_set_string_array(h, _encode_key(key), values_p, size))
 
 
 @require(msgid=int, key=str)
@@ -1270,7 +1771,7 @@ def grib_set_long_array(msgid, key, inarray):
     h = get_handle(msgid)
     if isinstance(inarray, np.ndarray):
         inarray = inarray.tolist()
-    GRIB_CHECK(lib.grib_set_long_array(h, key.encode(ENC), inarray, len(inarray)))
+    GRIB_CHECK(lib.grib_set_long_array(h, _encode_key(key), inarray, len(inarray)))
 
 
 @require(msgid=int, key=str)
@@ -1295,7 +1796,7 @@ def grib_get_long_array(msgid, key):
     length_p = ffi.new("size_t*", nval)
     arr = np.empty((nval,), dtype=dataType)
     vals_p = ffi.cast("long *", arr.ctypes.data)
-    err = lib.grib_get_long_array(h, key.encode(ENC), vals_p, length_p)
+    err = lib.grib_get_long_array(h, _encode_key(key), vals_p, length_p)
     GRIB_CHECK(err)
     return arr
 
@@ -1325,7 +1826,11 @@ def grib_multi_release(gribid):
     @param gribid    id of the multi-field we want to release the memory for
     @exception CodesInternalError
     """
+    if type(gribid) is MultiHandle:
+        gribid.release()
+        return
     mh = get_multi_handle(gribid)
+    registry.remove("MultiHandle", int(gribid))
     GRIB_CHECK(lib.grib_multi_handle_delete(mh))
 
 
@@ -1395,7 +1900,11 @@ def grib_index_release(indexid):
     @param indexid   id of an index created from a file.
     @exception CodesInternalError
     """
+    if type(indexid) is Index:
+        indexid.release()
+        return
     ih = get_index(indexid)
+    registry.remove("Index", int(indexid))
     lib.grib_index_delete(ih)
 
 
@@ -1413,8 +1922,8 @@ def grib_index_get_size(indexid, key):
     @exception CodesInternalError
     """
     ih = get_index(indexid)
-    size_p = ffi.new("size_t*")
-    err = lib.grib_index_get_size(ih, key.encode(ENC), size_p)
+    size_p = _scratch.size_p
+    err = lib.grib_index_get_size(ih, _encode_key(key), size_p)
     GRIB_CHECK(err)
     return size_p[0]
 
@@ -1440,7 +1949,7 @@ def grib_index_get_long(indexid, key):
 
     values_p = ffi.new("long[]", nval)
     size_p = ffi.new("size_t *", nval)
-    err = lib.grib_index_get_long(ih, key.encode(ENC), values_p, size_p)
+    err = lib.grib_index_get_long(ih, _encode_key(key), values_p, size_p)
     GRIB_CHECK(err)
     return tuple(int(values_p[i]) for i in range(size_p[0]))
 
@@ -1467,7 +1976,7 @@ def grib_index_get_string(indexid, key):
     values_keepalive = [ffi.new("char[]", max_val_size) for _ in range(nval)]
     values_p = ffi.new("const char *[]", values_keepalive)
     size_p = ffi.new("size_t *", max_val_size)
-    err = lib.grib_index_get_string(ih, key.encode(ENC), values_p, size_p)
+    err = lib.grib_index_get_string(ih, _encode_key(key), values_p, size_p)
     GRIB_CHECK(err)
     return tuple(ffi.string(values_p[i]).decode(ENC) for i in range(size_p[0]))
 
@@ -1493,7 +2002,7 @@ def grib_index_get_double(indexid, key):
 
     values_p = ffi.new("double[]", nval)
     size_p = ffi.new("size_t *", nval)
-    err = lib.grib_index_get_double(ih, key.encode(ENC), values_p, size_p)
+    err = lib.grib_index_get_double(ih, _encode_key(key), values_p, size_p)
     GRIB_CHECK(err)
     return tuple(values_p[i] for i in range(size_p[0]))
 
@@ -1515,7 +2024,7 @@ def grib_index_select_long(indexid, key, value):
     @exception CodesInternalError
     """
     iid = get_index(indexid)
-    GRIB_CHECK(lib.grib_index_select_long(iid, key.encode(ENC), value))
+    GRIB_CHECK(lib.grib_index_select_long(iid, _encode_key(key), value))
 
 
 @require(indexid=int, key=str, value=float)
@@ -1535,7 +2044,7 @@ def grib_index_select_double(indexid, key, value):
     @exception CodesInternalError
     """
     iid = get_index(indexid)
-    GRIB_CHECK(lib.grib_index_select_double(iid, key.encode(ENC), value))
+    GRIB_CHECK(lib.grib_index_select_double(iid, _encode_key(key), value))
 
 
 @require(indexid=int, key=str, value=str)
@@ -1555,7 +2064,7 @@ def grib_index_select_string(indexid, key, value):
     @exception CodesInternalError
     """
     ih = get_index(indexid)
-    GRIB_CHECK(lib.grib_index_select_string(ih, key.encode(ENC), value.encode(ENC)))
+    GRIB_CHECK(lib.grib_index_select_string(ih, _encode_key(key), value.encode(ENC)))
 
 
 @require(indexid=int)
@@ -1583,6 +2092,8 @@ def grib_new_from_index(indexid):
     elif err:
         GRIB_CHECK(err)
         return None
+    elif type(indexid) is Index:
+        return Handle(h)
     else:
         return put_handle(h)
 
@@ -1597,7 +2108,7 @@ def grib_get_message_size(msgid):
     @exception CodesInternalError
     """
     h = get_handle(msgid)
-    size_p = ffi.new("size_t*")
+    size_p = _scratch.size_p
     err = lib.grib_get_message_size(h, size_p)
     GRIB_CHECK(err)
     return size_p[0]
@@ -1613,7 +2124,7 @@ def grib_get_message_offset(msgid):
     @exception CodesInternalError
     """
     h = get_handle(msgid)
-    offset_p = ffi.new("long int*")
+    offset_p = _scratch.long_p
     err = lib.grib_get_message_offset(h, offset_p)
     GRIB_CHECK(err)
     return offset_p[0]
@@ -1633,7 +2144,7 @@ def grib_get_double_element(msgid, key, index):
     """
     h = get_handle(msgid)
     value_p = ffi.new("double*")
-    err = lib.grib_get_double_element(h, key.encode(ENC), index, value_p)
+    err = lib.grib_get_double_element(h, _encode_key(key), index, value_p)
     GRIB_CHECK(err)
     return value_p[0]
 
@@ -1654,7 +2165,7 @@ def grib_get_double_elements(msgid, key, indexes):
     h = get_handle(msgid)
     i_p = ffi.new("int[]", indexes)
     value_p = ffi.new("double[]", nidx)
-    err = lib.grib_get_double_elements(h, key.encode(ENC), i_p, nidx, value_p)
+    err = lib.grib_get_double_elements(h, _encode_key(key), i_p, nidx, value_p)
     GRIB_CHECK(err)
     return [float(v) for v in value_p]
 
@@ -1693,7 +2204,7 @@ def grib_set_missing(msgid, key):
     @exception CodesInternalError
     """
     h = get_handle(msgid)
-    GRIB_CHECK(lib.grib_set_missing(h, key.encode(ENC)))
+    GRIB_CHECK(lib.grib_set_missing(h, _encode_key(key)))
 
 
 @require(gribid=int)
@@ -1759,7 +2270,7 @@ def grib_is_missing(msgid, key):
     @exception CodesInternalError
     """
     h = get_handle(msgid)
-    err, value = err_last(lib.grib_is_missing)(h, key.encode(ENC))
+    err, value = err_last(lib.grib_is_missing)(h, _encode_key(key))
     GRIB_CHECK(err)
     return value
 
@@ -1774,7 +2285,7 @@ def grib_is_defined(msgid, key):
     @exception        GribInternalError
     """
     h = get_handle(msgid)
-    return lib.grib_is_defined(h, key.encode(ENC))
+    return lib.grib_is_defined(h, _encode_key(key))
 
 
 @require(gribid=int, inlat=(int, float), inlon=(int, float))
@@ -1933,13 +2444,10 @@ def grib_get_native_type(msgid, key):
     @exception CodesInternalError
     """
     h = get_handle(msgid)
-    itype_p = ffi.new("int*")
-    err = lib.grib_get_native_type(h, key.encode(ENC), itype_p)
+    itype_p = _scratch.int_p
+    err = lib.grib_get_native_type(h, _encode_key(key), itype_p)
     GRIB_CHECK(err)
-    if itype_p[0] in KEYTYPES:
-        return KEYTYPES[itype_p[0]]
-    else:
-        return None
+    return KEYTYPES.get(itype_p[0])
 
 
 @require(msgid=int, key=str)
@@ -2010,8 +2518,83 @@ def grib_get_array(msgid, key, ktype=None):
     return result
 
 
+def _get_item_value(msgid, h, name):
+    # The value of the key named by the C string name, see grib_get_items
+    scratch = _scratch
+    type_p, size_p = scratch.int_p, scratch.size_p
+    err = lib.grib_get_native_type(h, name, type_p)
+    if err == 0:
+        ktype = KEYTYPES.get(type_p[0])
+        err = lib.grib_get_size(h, name, size_p)
+    if err == 0 and size_p[0] > 1:
+        return grib_get_array(msgid, ffi.string(name).decode(ENC), ktype)
+    if err == 0:
+        if ktype is int:
+            err = lib.grib_get_long(h, name, scratch.long_p)
+            value = scratch.long_p[0]
+        elif ktype is float:
+            err = lib.grib_get_double(h, name, scratch.double_p)
+            value = scratch.double_p[0]
+        elif ktype is str:
+            chars = scratch.chars
+            size_p[0] = len(chars)
+            err = lib.grib_get_string(h, name, chars, size_p)
+            if err == lib.GRIB_BUFFER_TOO_SMALL:
+                GRIB_CHECK(lib.grib_get_length(h, name, size_p))
+                chars = scratch.char_buffer(size_p[0])
+                err = lib.grib_get_string(h, name, chars, size_p)
+            value = _decode_bytes(chars, size_p[0]) if err == 0 else None
+        else:
+            return None
+    if err == lib.GRIB_NOT_FOUND:
+        return None
+    GRIB_CHECK(err)
+    return value
+
+
+@require(msgid=int)
+def grib_get_items(msgid, namespace=None, skip_missing=True):
+    """
+    @brief Get the names and values of all the keys of a message in one pass.
+
+    The keys are iterated and their missing flag, type, size and value read with
+    direct calls to the library reusing the same buffers, several times faster
+    than @ref grib_keys_iterator_get_name followed by @ref grib_is_missing and
+    @ref grib_get for each key. Array keys are returned as NumPy arrays and the
+    keys without a value as None.
+
+    @param msgid          id of the message loaded in memory
+    @param namespace      the namespace of the keys (all the keys if None)
+    @param skip_missing   if True, leave out the keys set to MISSING
+    @return               list of (name, value) tuples
+    @exception CodesInternalError
+    """
+    h = get_handle(msgid)
+    bnamespace = ffi.NULL if namespace is None else namespace.encode(ENC)
+    kiter = lib.grib_keys_iterator_new(h, 0, bnamespace)
+    if kiter == ffi.NULL:
+        raise errors.GribInternalError("grib_get_items: keys iterator failed")
+    err_p = _scratch.err_p
+    items = []
+    try:
+        while True:
+            res = lib.grib_keys_iterator_next(kiter)
+            if res <= 0:
+                GRIB_CHECK(res)
+                break
+            name = lib.grib_keys_iterator_get_name(kiter)
+            if skip_missing and lib.grib_is_missing(h, name, err_p) and not err_p[0]:
+                continue
+            items.append(
+                (ffi.string(name).decode(ENC), _get_item_value(msgid, h, name))
+            )
+    finally:
+        lib.grib_keys_iterator_delete(kiter)
+    return items
+
+
 @require(gribid=int)
-def grib_get_values(gribid):
+def grib_get_values(gribid, out=None):
     """
     @brief Retrieve the contents of the 'values' key for a GRIB message.
 
@@ -2020,10 +2603,11 @@ def grib_get_values(gribid):
     \b Examples: \ref grib_print_data.py "grib_print_data.py", \ref grib_samples.py "grib_samples.py"
 
     @param gribid   id of the GRIB loaded in memory
+    @param out      optional C-contiguous float64 array the values are decoded into
     @return         numpy.ndarray
     @exception CodesInternalError
     """
-    return grib_get_double_array(gribid, "values")
+    return grib_get_double_array(gribid, "values", out)
 
 
 @require(gribid=int)
@@ -2234,17 +2818,18 @@ def grib_no_fail_on_wrong_length(flag):
 
 
 @require(flag=bool)
-def grib_gts_header(flag):
+def grib_gts_header(flag, context=None):
     """
     @brief Set the GTS header on/off.
 
-    @param flag True/False
+    @param flag      True/False
+    @param context   context to change, default is the one bound to the thread or the default one
     """
-    context = lib.grib_context_get_default()
+    c = get_context_or_default(context)
     if flag:
-        lib.grib_gts_header_on(context)
+        lib.grib_gts_header_on(c)
     else:
-        lib.grib_gts_header_off(context)
+        lib.grib_gts_header_off(c)
 
 
 def grib_get_api_version():
@@ -2268,7 +2853,11 @@ def grib_get_api_version():
     return "%d.%d.%d" % (major, minor, revision)
 
 
-__version__ = grib_get_api_version()
+def __getattr__(name):
+    # The library is only opened when the version is asked for, not at import
+    if name == "__version__":
+        return grib_get_api_version()
+    raise AttributeError(f"module {__name__!r} has no attribute {name!r}")
 
 
 def codes_get_version_info():
@@ -2324,65 +2913,88 @@ def grib_get_message(msgid):
     return fixed_length_buffer[:]
 
 
-@require(message=(bytes, str))
-def grib_new_from_message(message):
+def grib_new_from_message(message, context=None, copy=True):
     """
     @brief Create a handle from a message in memory.
 
     Create a new message from the input binary string and return its id.
 
+    Without a copy the message is decoded in place: no buffer is allocated for it,
+    the returned Handle keeps the memory alive and it must not be modified
+    until the Handle is released.
+
     @see grib_get_message
 
-    @param         message binary string message
-    @return        msgid of the newly created message
+    @param         message binary string message, or any object with a buffer
+    @param         context context used to decode the message, default is the one bound to the thread
+    @param         copy    if False, use the memory of message instead of a copy
+    @return        msgid of the newly created message, a Handle when not copied
     @exception CodesInternalError
     """
     if isinstance(message, str):
         message = message.encode(ENC)
-    h = lib.grib_handle_new_from_message_copy(ffi.NULL, message, len(message))
+    if not copy:
+        # The handle keeps the bound context alive as well as the one given
+        context = resolve_context(context)
+        data = ffi.from_buffer(message)
+        h = lib.grib_handle_new_from_message(get_context(context), data, len(data))
+        if h == ffi.NULL:
+            raise errors.InvalidGribError("new_from_message failed")
+        return Handle(h, parent=(data, context))
+    if not isinstance(message, bytes):
+        message = ffi.from_buffer(message)
+    h = lib.grib_handle_new_from_message_copy(
+        get_context(context), message, len(message)
+    )
     if h == ffi.NULL:
         raise errors.InvalidGribError("new_from_message failed")
-    return put_handle(h)
+    return put_context_handle(h, context)
 
 
-def codes_definition_path():
+def codes_definition_path(context=None):
     """
     @brief Get the definition path
+
+    @param context   context to query, default is the one bound to the thread or the default one
     """
-    context = lib.grib_context_get_default()
-    dpath = lib.codes_definition_path(context)
+    dpath = lib.codes_definition_path(get_context_or_default(context))
     return ffi.string(dpath).decode(ENC)
 
 
-def codes_samples_path():
+def codes_samples_path(context=None):
     """
     @brief Get the samples path
+
+    @param context   context to query, default is the one bound to the thread or the default one
     """
-    context = lib.grib_context_get_default()
-    spath = lib.codes_samples_path(context)
+    spath = lib.codes_samples_path(get_context_or_default(context))
     return ffi.string(spath).decode(ENC)
 
 
 @require(defs_path=str)
-def grib_set_definitions_path(defs_path):
+def grib_set_definitions_path(defs_path, context=None):
     """
     @brief Set the definitions path
 
     @param defs_path   definitions path
+    @param context     context to change, default is the one bound to the thread or the default one
     """
-    context = lib.grib_context_get_default()
-    lib.grib_context_set_definitions_path(context, defs_path.encode(ENC))
+    lib.grib_context_set_definitions_path(
+        get_context_or_default(context), defs_path.encode(ENC)
+    )
 
 
 @require(samples_path=str)
-def grib_set_samples_path(samples_path):
+def grib_set_samples_path(samples_path, context=None):
     """
     @brief Set the samples path
 
     @param samples_path   samples path
+    @param context        context to change, default is the one bound to the thread or the default one
     """
-    context = lib.grib_context_get_default()
-    lib.grib_context_set_samples_path(context, samples_path.encode(ENC))
+    lib.grib_context_set_samples_path(
+        get_context_or_default(context), samples_path.encode(ENC)
+    )
 
 
 def grib_context_delete():
@@ -2392,26 +3004,128 @@ def grib_context_delete():
     lib.grib_context_delete(ffi.NULL)
 
 
-def codes_bufr_multi_element_constant_arrays_on():
+def grib_context_new(
+    parent=None,
+    definitions_path=None,
+    samples_path=None,
+    gts_header=None,
+    multi_support=None,
+    gribex_mode=None,
+    allocator=None,
+):
+    """
+    @brief Create a new context, independent of the default one.
+
+    Messages created with the new context do not share its caches and locks
+    with the other threads, so a context per thread lets them decode in parallel.
+    The context has its own definitions and samples paths and flags, so
+    contexts with different settings can be used in the same process.
+    The context is deleted when the returned object is garbage collected,
+    after all the messages created with it.
+
+    @param parent             context to copy the settings from, default is the default context
+    @param definitions_path   definitions path of the new context
+    @param samples_path       samples path of the new context
+    @param gts_header         True/False to turn the GTS header on/off
+    @param multi_support      True/False to turn the multiple fields support on/off
+    @param gribex_mode        True/False to turn the compatibility mode with GRIBEX on/off
+    @param allocator          allocator of the memory of the messages, see @ref grib_context_set_allocator
+    @return                   the new context
+    @exception CodesInternalError
+    """
+    c = lib.grib_context_new(ffi.NULL if parent is None else get_context(parent))
+    if c == ffi.NULL:
+        raise errors.GribInternalError("context_new failed")
+    context = Context(c)
+    if definitions_path is not None:
+        grib_set_definitions_path(definitions_path, context)
+    if samples_path is not None:
+        grib_set_samples_path(samples_path, context)
+    if gts_header is not None:
+        grib_gts_header(gts_header, context)
+    if multi_support is not None:
+        if multi_support:
+            grib_multi_support_on(context)
+        else:
+            grib_multi_support_off(context)
+    if gribex_mode is not None:
+        if gribex_mode:
+            grib_gribex_mode_on(context)
+        else:
+            grib_gribex_mode_off(context)
+    if allocator is not None:
+        grib_context_set_allocator(context, allocator)
+    return context
+
+
+def grib_context_set_allocator(context, allocator):
+    """
+    @brief Allocate the memory of the messages of a context with a Python allocator.
+
+    The allocator gets the memory of the messages and of their data buffers,
+    for instance an ArenaAllocator reset between batches of messages.
+    It must be set before any message is created with the context and it is
+    kept alive by the context.
+
+    It bounds and groups the memory of the messages, it does not make them
+    faster to decode: every allocation calls back into Python with the GIL,
+    so the threads decoding with such contexts wait for each other at each one.
+
+    @param context     context returned by @ref codes_context_new
+    @param allocator   instance of a subclass of Allocator
+    @exception GribInternalError
+    """
+    if type(context) is not Context:
+        # Memory already allocated with malloc could be given to the allocator
+        raise errors.GribInternalError("Allocators can only be set on new contexts")
+    p_malloc, p_free, p_realloc = allocator.callbacks()
+    lib.grib_context_set_memory_proc(context.cdata, p_malloc, p_free, p_realloc)
+    lib.grib_context_set_buffer_memory_proc(context.cdata, p_malloc, p_free, p_realloc)
+    context.allocator = allocator
+
+
+def grib_context_bind(context):
+    """
+    @brief Bind a context to the current thread.
+
+    The functions creating messages use the context bound to the thread
+    when they are not given one explicitly. Other threads are not affected.
+
+    @param context   context returned by @ref codes_context_new, or None to unbind
+    @return          the context previously bound to the thread, or None
+    """
+    previous = getattr(_bound_context, "context", None)
+    _bound_context.context = context
+    return previous
+
+
+def grib_context_get_bound():
+    """
+    @brief Get the context bound to the current thread, or None.
+    """
+    return getattr(_bound_context, "context", None)
+
+
+def codes_bufr_multi_element_constant_arrays_on(context=None):
     """
     @brief BUFR: Turn on the mode where you get multiple elements
     in constant arrays
 
+    @param context   context to change, default is the one bound to the thread or the default one
     @exception CodesInternalError
     """
-    context = lib.grib_context_get_default()
-    lib.codes_bufr_multi_element_constant_arrays_on(context)
+    lib.codes_bufr_multi_element_constant_arrays_on(get_context_or_default(context))
 
 
-def codes_bufr_multi_element_constant_arrays_off():
+def codes_bufr_multi_element_constant_arrays_off(context=None):
     """
     @brief BUFR: Turn off the mode where you get multiple elements
     in constant arrays i.e. you get a single element
 
+    @param context   context to change, default is the one bound to the thread or the default one
     @exception CodesInternalError
     """
-    context = lib.grib_context_get_default()
-    lib.codes_bufr_multi_element_constant_arrays_off(context)
+    lib.codes_bufr_multi_element_constant_arrays_off(get_context_or_default(context))
 
 
 @require(msgid=int)
@@ -2487,7 +3201,7 @@ def codes_bufr_key_is_header(msgid, key):
     @exception CodesInternalError
     """
     h = get_handle(msgid)
-    err, value = err_last(lib.codes_bufr_key_is_header)(h, key.encode(ENC))
+    err, value = err_last(lib.codes_bufr_key_is_header)(h, _encode_key(key))
     GRIB_CHECK(err)
     return value
 
@@ -2520,6 +3234,60 @@ def codes_extract_offsets(filepath, product_kind, is_strict=True):
         i += 1
 
 
+def codes_scan_references(
+    filepath, keys=(), product_kind=CODES_PRODUCT_GRIB, context=None, start=0, stop=None
+):
+    """
+    @brief Byte range references of the messages of a file.
+
+    The messages are read in one pass and their values are not decoded. With
+    CODES_PRODUCT_GRIB, the default, they are loaded headers only so the data
+    sections are skipped, the other products such as CODES_PRODUCT_ANY for files
+    of mixed products are loaded in full. The offset and length are
+    those of each message in the file: the length is the totalLength key, or
+    the size of the message for products without it.
+
+    @param filepath       path of input file
+    @param keys           names of the scalar header keys to read
+    @param product_kind   one of CODES_PRODUCT_GRIB, CODES_PRODUCT_BUFR, CODES_PRODUCT_ANY or CODES_PRODUCT_GTS
+    @param context        context used to load the messages
+    @param start          offset of the first message to read
+    @param stop           offset where the scan stops, default is the end of the file
+    @return               a generator that yields a dictionary per message with its
+                          offset, length and keys, None for the keys not found
+    @exception CodesInternalError
+    """
+    reserved = [key for key in keys if key in ("offset", "length")]
+    if reserved:
+        raise ValueError(f"codes_scan_references: keys {reserved} are reserved")
+    with open(filepath, "rb") as fileobj:
+        fileobj.seek(start)
+        while True:
+            msgid = codes_new_from_file(
+                fileobj, product_kind, headers_only=True, context=context
+            )
+            if msgid is None:
+                break
+            try:
+                offset = grib_get_message_offset(msgid)
+                if stop is not None and offset >= stop:
+                    break
+                try:
+                    # The message loaded headers only is shorter than in the file
+                    length = grib_get_long(msgid, "totalLength")
+                except errors.KeyValueNotFoundError:
+                    length = grib_get_message_size(msgid)
+                reference = {"offset": offset, "length": length}
+                for key in keys:
+                    try:
+                        reference[key] = grib_get(msgid, key)
+                    except errors.KeyValueNotFoundError:
+                        reference[key] = None
+            finally:
+                grib_release(msgid)
+            yield reference
+
+
 # -------------------------------
 # EXPERIMENTAL FEATURES
 # -------------------------------
@@ -2528,20 +3296,28 @@ def grib_nearest_new(msgid):
     h = get_handle(msgid)
     err, nid = err_last(lib.grib_nearest_new)(h)
     GRIB_CHECK(err)
+    if type(msgid) is Handle:
+        return Nearest(nid, msgid)
     return put_grib_nearest(nid)
 
 
 def put_grib_nearest(nid):
-    return int(ffi.cast("size_t", nid))
+    return registry.put("Nearest", nid)
 
 
 def get_grib_nearest(nid):
+    if type(nid) is Nearest:
+        return nid.cdata
     return ffi.cast("grib_nearest*", nid)
 
 
 @require(nid=int)
 def grib_nearest_delete(nid):
+    if type(nid) is Nearest:
+        nid.release()
+        return
     nh = get_grib_nearest(nid)
+    registry.remove("Nearest", int(nid))
     lib.grib_nearest_delete(nh)
 
 
@@ -2598,4 +3374,4 @@ def grib_nearest_find(nid, gribid, inlat, inlon, flags, is_lsm=False, npoints=4)
 
 
 def codes_get_library_path():
-    return library_path
+    return bindings.library_path
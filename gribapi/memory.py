@@ -0,0 +1,184 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Allocators for the memory of the messages of a context
+"""
+
+import threading
+
+from . import errors
+from .bindings import ffi, lib
+
+
+class Allocator:
+    """
+    @brief Base class of the allocators installed in a context.
+
+    Subclasses implement @ref malloc, @ref free and @ref realloc on cdata
+    pointers. They are called by the C library for the memory of the messages
+    created with the context, never for the definitions which are allocated
+    once and kept for the lifetime of the context.
+
+    Each allocation of the C library takes the GIL to call back into Python,
+    so the threads using the context are serialised on it, and the methods
+    must be thread safe as the context may be used by several threads.
+    """
+
+    def malloc(self, size):
+        raise NotImplementedError
+
+    def free(self, pointer):
+        raise NotImplementedError
+
+    def realloc(self, pointer, size):
+        raise NotImplementedError
+
+    def callbacks(self):
+        """Return the (malloc, free, realloc) C callbacks calling this allocator"""
+        if not hasattr(self, "_callbacks"):
+            # The callbacks must stay alive as long as a context may call them
+            self._callbacks = (
+                ffi.callback("grib_malloc_proc", lambda c, size: self.malloc(size)),
+                ffi.callback("grib_free_proc", lambda c, pointer: self.free(pointer)),
+                ffi.callback(
+                    "grib_realloc_proc",
+                    lambda c, pointer, size: self.realloc(pointer, size),
+                ),
+            )
+        return self._callbacks
+
+
+class ArenaAllocator(Allocator):
+    """
+    @brief Allocate the memory of the messages from large chunks, all freed at once.
+
+    Blocks are carved sequentially from chunks of @em chunk_size bytes and
+    freeing a block does not give its memory back: it is reused only after
+    @ref reset, called between batches of messages once they have all been
+    released. The memory is not fragmented by the many small allocations of
+    the decoding and is returned in a few large pieces.
+
+    The blocks not allocated by the arena, e.g. by the context before the
+    allocator was set, are given back to the system allocator. The arena
+    is locked, it can be shared by contexts used in several threads, but as
+    any Allocator it takes the GIL at each allocation: the decoding threads
+    do not run their allocations in parallel as with the default allocator.
+
+    @param chunk_size   size in bytes of each chunk, larger blocks get their own chunk
+    """
+
+    ALIGNMENT = 16
+    HEADER = 16  # the size of the block is stored in front of it
+
+    def __init__(self, chunk_size=16 * 1024 * 1024):
+        self.chunk_size = chunk_size
+        self._chunks = []
+        self._ranges = []
+        self._base = None
+        self._offset = 0
+        self._capacity = 0
+        self.blocks_in_use = 0
+        self.bytes_allocated = 0
+        self._lock = threading.Lock()
+
+    def _new_chunk(self, size):
+        chunk = ffi.new("char[]", max(self.chunk_size, size))
+        self._chunks.append(chunk)
+        self._base = ffi.cast("char *", chunk)
+        start = int(ffi.cast("size_t", self._base))
+        self._ranges.append((start, start + len(chunk)))
+        self._offset = 0
+        self._capacity = len(chunk)
+
+    def _owns(self, pointer):
+        address = int(ffi.cast("size_t", pointer))
+        return any(start <= address < end for start, end in self._ranges)
+
+    def malloc(self, size):
+        with self._lock:
+            return self._malloc(size)
+
+    def free(self, pointer):
+        if pointer == ffi.NULL:
+            return
+        with self._lock:
+            if self._owns(pointer):
+                self.blocks_in_use -= 1
+                return
+        lib.grib_context_free(lib.grib_context_get_default(), pointer)
+
+    def realloc(self, pointer, size):
+        if pointer == ffi.NULL:
+            return self.malloc(size)
+        with self._lock:
+            if self._owns(pointer):
+                return self._realloc(pointer, size)
+        # Not allocated by this arena, its size is only known to the system allocator
+        return lib.grib_context_realloc(lib.grib_context_get_default(), pointer, size)
+
+    def _malloc(self, size):
+        total = self.HEADER + -(-size // self.ALIGNMENT) * self.ALIGNMENT
+        if self._offset + total > self._capacity:
+            self._new_chunk(total)
+        block = self._base + self._offset
+        ffi.cast("size_t *", block)[0] = size
+        self._offset += total
+        self.blocks_in_use += 1
+        self.bytes_allocated += size
+        return ffi.cast("void *", block + self.HEADER)
+
+    def _realloc(self, pointer, size):
+        block = ffi.cast("char *", pointer) - self.HEADER
+        old_size = ffi.cast("size_t *", block)[0]
+        if size <= old_size:
+            return pointer
+        old_total = self.HEADER + -(-old_size // self.ALIGNMENT) * self.ALIGNMENT
+        total = self.HEADER + -(-size // self.ALIGNMENT) * self.ALIGNMENT
+        if block + old_total == self._base + self._offset and (
+            self._offset - old_total + total <= self._capacity
+        ):
+            # The last block of the chunk grows in place
+            ffi.cast("size_t *", block)[0] = size
+            self._offset += total - old_total
+            self.bytes_allocated += size - old_size
+            return pointer
+        new_pointer = self._malloc(size)
+        ffi.memmove(new_pointer, pointer, old_size)
+        self.blocks_in_use -= 1
+        return new_pointer
+
+    def reset(self):
+        """
+        @brief Make all the memory of the arena available again.
+
+        All the messages created with the context must have been released.
+        The first chunk is kept for the next batch, the others are freed.
+
+        @exception GribInternalError if some blocks are still in use
+        """
+        with self._lock:
+            if self.blocks_in_use:
+                raise errors.GribInternalError(
+                    f"ArenaAllocator: {self.blocks_in_use} blocks still in use"
+                )
+            del self._chunks[1:], self._ranges[1:]
+            if self._chunks:
+                self._base = ffi.cast("char *", self._chunks[0])
+                self._capacity = len(self._chunks[0])
+            self._offset = 0
+            self.bytes_allocated = 0
+
+    @property
+    def bytes_reserved(self):
+        """Size in bytes of all the chunks of the arena"""
+        with self._lock:
+            return sum(len(chunk) for chunk in self._chunks)
@@ -0,0 +1,109 @@
+#
+# (C) Copyright 2017- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+#
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation nor
+# does it submit to any jurisdiction.
+#
+
+"""
+Registry of the live objects of the C library: messages, indexes, iterators,
+nearest objects and contexts, created and not yet released.
+
+In debug mode the stack where each object was created is kept, and the objects
+still alive at exit are reported with it.
+"""
+
+import atexit
+import gc
+import logging
+import os
+import threading
+import traceback
+
+from .bindings import ffi
+
+LOG = logging.getLogger(__name__)
+
+# Keep the creation stacks and report the leaks at exit
+debug = os.environ.get("ECCODES_PYTHON_DEBUG_HANDLES", "0") == "1"
+
+# {kind: {address: (creation stack, or None when not in debug mode, size in bytes)}}
+_live = {}
+# Reentrant as the objects may be removed by the garbage collector at any time
+_lock = threading.RLock()
+
+
+def add(kind, address, nbytes=0):
+    if debug:
+        stack = [f for f in traceback.extract_stack() if f.filename != __file__]
+    else:
+        stack = None
+    with _lock:
+        _live.setdefault(kind, {})[address] = (stack, nbytes)
+
+
+def put(kind, cdata, nbytes=0):
+    """Register a new object owned by the caller and return its legacy id"""
+    address = int(ffi.cast("size_t", cdata))
+    add(kind, address, nbytes)
+    return address
+
+
+def remove(kind, address):
+    with _lock:
+        _live.get(kind, {}).pop(address, None)
+
+
+def live(kind):
+    """Return the addresses of the live objects of a kind"""
+    with _lock:
+        return list(_live.get(kind, {}))
+
+
+def counts():
+    with _lock:
+        return {kind: len(objects) for kind, objects in _live.items() if objects}
+
+
+def totals():
+    """Return the number and the total size in bytes of the live objects by kind"""
+    with _lock:
+        return {
+            kind: (len(objects), sum(nbytes for _, nbytes in objects.values()))
+            for kind, objects in _live.items()
+            if objects
+        }
+
+
+def set_debug(flag):
+    global debug
+    debug = bool(flag)
+
+
+def leaks_report():
+    """Return the description of the live objects with their creation stack"""
+    with _lock:
+        snapshot = [(kind, list(objects.items())) for kind, objects in _live.items()]
+    lines = []
+    for kind, objects in snapshot:
+        for address, (stack, _) in objects:
+            lines.append(f"{kind} {address:#x} created at:")
+            if stack is None:
+                lines.append("  (unknown, created before the debug mode was on)\n")
+            else:
+                lines.extend(traceback.format_list(stack))
+    return "".join(line if line.endswith("\n") else line + "\n" for line in lines)
+
+
+@atexit.register
+def _report_leaks():
+    if debug:
+        # The objects only kept alive by reference cycles are not leaks
+        gc.collect()
+        report = leaks_report()
+        if report:
+            LOG.warning("ecCodes objects not released at exit:\n%s", report)
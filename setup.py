@@ -16,6 +16,7 @@ import re
 import sys
 
 import setuptools
+from setuptools.command.build_py import build_py
 
 
 def read(path):
@@ -36,6 +37,18 @@ def parse_version_from(path):
     return version_match.group(1)
 
 
+class build_py_abi(build_py):
+    """Also parse the C declarations into gribapi/_bindings_abi.py, see builder.py"""
+
+    def run(self):
+        super().run()
+        if not self.dry_run:
+            sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+            import builder
+
+            builder.build_abi(self.build_lib)
+
+
 install_requires = ["numpy"]
 if sys.version_info < (3, 7):
     install_requires = ["numpy<1.20"]
@@ -55,6 +68,8 @@ setuptools.setup(
     url="https://github.com/ecmwf/eccodes-python",
     packages=setuptools.find_packages(),
     include_package_data=True,
+    setup_requires=["cffi"],
+    cmdclass={"build_py": build_py_abi},
     install_requires=install_requires,
     tests_require=[
         "pytest",
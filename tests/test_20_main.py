@@ -1,6 +1,14 @@
+import json
+import os
+import pathlib
+
 import pytest
 
-from eccodes import __main__
+import eccodes
+from eccodes import __main__, references
+
+SAMPLE_DATA_FOLDER = pathlib.Path(__file__).parent / "sample-data"
+TEST_DATA = SAMPLE_DATA_FOLDER / "era5-levels-members.grib"
 
 
 def test_main(capsys):
@@ -11,3 +19,101 @@ def test_main(capsys):
 
     with pytest.raises(RuntimeError):
         __main__.main(argv=["non-existent-command"])
+
+
+def test_main_scan(capsys):
+    __main__.main(argv=["scan", str(TEST_DATA), "--format", "json"])
+    stdout, _ = capsys.readouterr()
+    rows = json.loads(stdout)
+
+    assert len(rows) == 160
+    assert rows[0]["offset"] == 0
+    assert rows[1]["offset"] >= rows[0]["length"]
+    assert rows[0]["shortName"] == "z"
+
+    argv = ["scan", str(TEST_DATA), "--product", "any", "--format", "json"]
+    __main__.main(argv=argv)
+    stdout, _ = capsys.readouterr()
+
+    # The GRIB messages are loaded headers only, with the length of the whole message
+    assert json.loads(stdout) == rows
+
+    # The messages of the file are split between the processes
+    assert len(__main__.split_file(str(TEST_DATA), "grib", 4)) == 4
+    argv = ["scan", str(TEST_DATA), "--workers", "4", "--format", "json"]
+    __main__.main(argv=argv)
+    stdout, _ = capsys.readouterr()
+
+    assert json.loads(stdout) == rows
+
+    __main__.main(argv=["scan", str(TEST_DATA), "--keys", "shortName,level"])
+    stdout, _ = capsys.readouterr()
+
+    assert stdout.splitlines()[0] == "path,offset,length,shortName,level"
+
+
+def test_main_references(capsys, tmp_path):
+    for format in ["json", "npz"]:
+        output = str(tmp_path / f"test.{format}")
+        argv = ["references", str(TEST_DATA), "--format", format, "--output", output]
+        __main__.main(argv=argv)
+        stdout, _ = capsys.readouterr()
+        assert stdout.startswith(f"{output}: 160 messages")
+
+        with open(output, "rb") as file:
+            refs = references.load(file)
+        assert refs["columns"][:2] == ["offset", "length"]
+        assert len(refs["refs"]) == 160
+        offset, length = refs["refs"][1][:2]
+        assert offset == length == refs["refs"][0][1]
+        handle = references.read_message(refs, 1)
+        shortName = refs["refs"][1][refs["columns"].index("shortName")]
+        assert eccodes.codes_get(handle, "shortName") == shortName
+
+
+def test_references_npz(tmp_path):
+    refs = {
+        "version": 1,
+        "path": "test.grib",
+        "columns": ["offset", "length", "level", "values"],
+        "refs": [[0, 10, 1, "a"], [10, 20, None, 2.5], [30, 5, 3, None]],
+    }
+    with open(tmp_path / "refs.npz", "wb") as file:
+        references.dump(refs, file, "npz")
+    # The column of mixed types is loaded without pickle
+    with open(tmp_path / "refs.npz", "rb") as file:
+        assert references.load(file) == refs
+
+    # The missing values keep the type of the columns
+    refs["columns"] = ["offset", "length", "level", "shortName", "step"]
+    refs["refs"] = [
+        [0, 10, 1, "2t", None],
+        [10, 20, None, None, None],
+        [30, 5, 3, "", 6],
+    ]
+    with open(tmp_path / "refs.npz", "wb") as file:
+        references.dump(refs, file, "npz")
+    with open(tmp_path / "refs.npz", "rb") as file:
+        loaded = references.load(file)
+    assert loaded == refs
+    assert [type(row[2]) for row in loaded["refs"]] == [int, type(None), int]
+
+
+def test_main_index(capsys, tmp_path):
+    indexpath = str(tmp_path / "test.idx")
+    __main__.main(argv=["index", str(TEST_DATA), "--indexpath", indexpath])
+    stdout, _ = capsys.readouterr()
+
+    assert stdout.startswith(f"{indexpath}: 160 messages")
+    assert os.path.exists(indexpath)
+
+
+def test_main_bench(capsys):
+    __main__.main(argv=["bench", str(TEST_DATA), "--repeat", "1"])
+    stdout, _ = capsys.readouterr()
+
+    assert len(stdout.splitlines()) == 3
+    assert "messages/s" in stdout
+
+    with pytest.raises(SystemExit):
+        __main__.main(argv=["bench", str(TEST_DATA), "--repeat", "0"])
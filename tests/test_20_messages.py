@@ -1,9 +1,12 @@
+import concurrent.futures
 import os.path
+import pickle
 
 import numpy as np
 import pytest
 
-from eccodes import messages
+import eccodes
+from eccodes import cache, messages
 
 SAMPLE_DATA_FOLDER = os.path.join(os.path.dirname(__file__), "sample-data")
 TEST_DATA = os.path.join(SAMPLE_DATA_FOLDER, "era5-levels-members.grib")
@@ -97,6 +100,34 @@ def _test_ComputedKeysMessage_read():
         res["error_key"]
 
 
+def test_Message_keys():
+    res = messages.Message.from_sample_name("regular_ll_pl_grib2")
+    keys = res.message_keys()
+    assert res.message_keys() is keys
+    assert list(res) == list(keys) == list(res.message_grib_keys())
+    assert len(res) == len(keys)
+
+    res["gridType"] = "reduced_gg"
+    assert res.message_keys() is not keys
+    assert list(res) == list(res.message_grib_keys())
+
+    computed_keys = {"ref_time": (lambda m: None, None), "centre": (None, None)}
+    res = messages.ComputedKeysMessage.from_sample_name(
+        "regular_ll_pl_grib2", computed_keys=computed_keys
+    )
+    assert list(res) == list(res.message_grib_keys()) + ["ref_time"]
+
+
+def test_Message_pickle():
+    res = messages.Message.from_sample_name("regular_ll_pl_grib2", errors="raise")
+    res["Ni"] = 20
+    for protocol in [2, 5]:
+        copy = pickle.loads(pickle.dumps(res, protocol=protocol))
+        assert copy["Ni"] == 20
+        assert copy.errors == "raise"
+        assert copy.codes_id != res.codes_id
+
+
 def test_ComputedKeysMessage_write():
     computed_keys = {
         "ref_time": (lambda m: "%s%04d" % (m["dataDate"], m["dataTime"]), None),
@@ -226,3 +257,139 @@ def _test_FileStream():
     # res = messages.FileStream(str(__file__), errors='raise')
     # with pytest.raises(bindings.EcCodesError):
     #     res.first()
+
+
+def test_FileIndex_to_array():
+    index = messages.FileStream(TEST_DATA).index(
+        ["shortName", "number", "dataTime", "level"], indexpath=""
+    )
+    with pytest.raises(ValueError):
+        index.to_array(["number", "dataTime", "level"])
+
+    res = index.subindex(shortName="t").to_array(["number", "dataTime", "level"])
+    assert res.dims == ["number", "dataTime", "level"]
+    assert res.shape == (10, 4, 2, 61, 120)
+    assert res.coords["level"] == [500, 850]
+
+    subindex = index.subindex(shortName="t", number=0, dataTime=0, level=500)
+    with open(TEST_DATA, "rb") as file:
+        first = messages.Message.from_file(file, offset=subindex.offsets[0][1][0])
+        values = first.message_get("values", float).reshape(61, 120)
+    assert np.array_equal(res[0, 0, 0], values)
+    assert np.array_equal(res[0, 0, 0, 10:20, 5], values[10:20, 5])
+    assert res[:, 0, 1].shape == (10, 61, 120)
+    assert res[..., 0, 0].shape == (10, 4, 2)
+    assert np.array_equal(res[[0, 2], -1:][0, 0, 1], res[0, 3, 1])
+
+    with pytest.raises(ValueError, match="no message"):
+        index.subindex(shortName="unknown").to_array(["number"])
+
+
+def test_FileIndex_to_table():
+    index = messages.FileStream(TEST_DATA).index(
+        ["shortName", "number", "level"], indexpath=""
+    )
+    res = index.to_table(backend="numpy")
+    assert res.dtype.names == (
+        "shortName",
+        "number",
+        "level",
+        "offset",
+        "field_in_message",
+    )
+    assert len(res) == 160
+    assert res["number"].dtype == np.int64
+    assert sorted(set(res["shortName"])) == ["t", "z"]
+    assert sorted(res["offset"]) == sorted(
+        offset for _, offsets in index.offsets for offset in offsets
+    )
+
+    pyarrow = pytest.importorskip("pyarrow")
+    res = index.to_table(backend="arrow")
+    assert isinstance(res, pyarrow.Table)
+    assert res.num_rows == 160
+    assert res.column_names[-2:] == ["offset", "field_in_message"]
+
+
+def test_FieldsArray_chunks():
+    index = messages.FileStream(TEST_DATA).index(
+        ["shortName", "number", "dataTime", "level"], indexpath=""
+    )
+    res = index.subindex(shortName="t").to_array(["number", "dataTime", "level"])
+    assert res.chunks == ((1,) * 10, (1,) * 4, (1,) * 2, (61,), (120,))
+    assert res.numblocks == (10, 4, 2, 1, 1)
+
+    graph = res.dask_graph("t")
+    assert len(graph) == 80
+    task = pickle.loads(pickle.dumps(graph[("t", 9, 3, 1, 0, 0)]))
+    assert np.array_equal(task[0](*task[1:]), res[9:, 3:, 1:])
+    assert np.array_equal(res.load_chunk((0, 1, 0, 0, 0)), res[:1, 1:2, :1])
+
+
+def test_FieldsArray_to_dask():
+    pytest.importorskip("dask.array")
+    index = messages.FileStream(TEST_DATA).index(
+        ["shortName", "number", "dataTime", "level"], indexpath=""
+    )
+    res = index.subindex(shortName="t").to_array(["number", "dataTime", "level"])
+    array = res.to_dask()
+    assert array.shape == res.shape
+    assert np.array_equal(array[2:4, 1, 0].compute(), res[2:4, 1, 0])
+
+
+def test_handle_cache(tmpdir):
+    grib_file = str(tmpdir.join("file.grib"))
+    with open(TEST_DATA, "rb") as source, open(grib_file, "wb") as file:
+        file.write(source.read())
+    handle_cache = eccodes.set_handle_cache(10 * 1024**2)
+    try:
+        index = messages.FileStream(grib_file).index(
+            ["shortName", "number", "dataTime", "level"], indexpath=""
+        )
+        offset = index.offsets[1][1][0]
+        with open(grib_file, "rb") as file:
+            res1 = messages.Message.from_file(file, offset=offset)
+            res2 = messages.Message.from_file(file, offset=offset)
+        assert res1.codes_id != res2.codes_id
+        assert res1["paramId"] == res2["paramId"]
+        assert handle_cache.info()["hits"] == 1
+
+        array = index.subindex(shortName="t").to_array(["number", "dataTime", "level"])
+        assert np.array_equal(array[0, 0], array[0, 0])
+        assert handle_cache.info()["hits"] == 3
+        assert handle_cache.info()["nbytes"] <= 10 * 1024**2
+
+        # a modified file is read again
+        os.utime(grib_file, ns=(0, 0))
+        with open(grib_file, "rb") as file:
+            messages.Message.from_file(file, offset=offset)
+        assert handle_cache.info()["misses"] == 4
+    finally:
+        eccodes.set_handle_cache(0)
+
+
+def test_lru_cache_reentrant():
+    lru = cache.LRUCache(1024)
+    lru.put("a", np.zeros(2))
+    # As a finalizer run by the garbage collector in a thread holding the lock
+    with lru._lock:
+        lru.discard("a")
+    assert len(lru) == 0 and lru.nbytes == 0
+
+
+def test_handle_cache_shared(tmpdir):
+    link = str(tmpdir.join("link.grib"))
+    os.symlink(os.path.abspath(TEST_DATA), link)
+    handle_cache = eccodes.set_handle_cache(10 * 1024**2)
+    try:
+        # The same file is cached once whatever the path it is opened with
+        with concurrent.futures.ThreadPoolExecutor(4) as executor:
+            results = list(
+                executor.map(
+                    lambda path: handle_cache.values(path, 0), [TEST_DATA, link] * 4
+                )
+            )
+        assert all(values is results[0] for values in results)
+        assert len(handle_cache) == 1
+    finally:
+        eccodes.set_handle_cache(0)
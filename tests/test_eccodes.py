@@ -13,13 +13,20 @@
 Tests of the ecCodes Python3 bindings
 """
 
+import concurrent.futures
+import importlib.util
 import math
 import os.path
+import runpy
+import subprocess
+import sys
+import threading
 
 import numpy as np
 import pytest
 
 import eccodes
+from gribapi import gribapi
 
 SAMPLE_DATA_FOLDER = os.path.join(os.path.dirname(__file__), "sample-data")
 TEST_GRIB_TIGGE_DATA = os.path.join(SAMPLE_DATA_FOLDER, "tiggelam_cnmc_sfc.grib2")
@@ -59,6 +66,312 @@ def test_version_info():
     assert len(vinfo) == 2
 
 
+def test_set_type_checks():
+    saved = gribapi.enable_type_checks, gribapi.enable_fast_path
+    gid = eccodes.codes_grib_new_from_samples("GRIB2")
+    try:
+        eccodes.codes_set_type_checks(True, fast_path=False)
+        with pytest.raises(AssertionError):
+            eccodes.codes_get_long(gid, 1)
+        # The hot path is bound without the decorator
+        eccodes.codes_set_type_checks(True)
+        assert not hasattr(eccodes.codes_get_long, "__wrapped__")
+        with pytest.raises(AssertionError):
+            eccodes.codes_set_long(gid, 1, 1)
+        eccodes.codes_set_type_checks(False)
+        assert eccodes.codes_set_long is gribapi.grib_set_long
+        assert not hasattr(eccodes.codes_set_long, "__wrapped__")
+    finally:
+        eccodes.codes_set_type_checks(*saved)
+    eccodes.codes_release(gid)
+
+
+def test_key_cache():
+    eccodes.codes_key_cache_clear()
+    gid = eccodes.codes_grib_new_from_samples("GRIB2")
+    for _ in range(3):
+        eccodes.codes_get_long(gid, "edition")
+        eccodes.codes_get_string(gid, "shortName")
+    info = eccodes.codes_key_cache_info()
+    assert info.misses == 2
+    assert info.hits >= 4
+    eccodes.codes_key_cache_clear()
+    assert eccodes.codes_key_cache_info().currsize == 0
+    eccodes.codes_release(gid)
+
+
+def test_stats():
+    gid = eccodes.codes_grib_new_from_samples("GRIB2")
+    eccodes.codes_set_stats(True)
+    try:
+        eccodes.reset_stats()
+        for _ in range(3):
+            eccodes.codes_get_long(gid, "edition")
+        shortName = eccodes.codes_get_string(gid, "shortName")
+        stats = eccodes.stats()
+        assert stats["grib_get_long"]["calls"] == 3
+        assert stats["grib_get_long"]["time"] > 0
+        assert stats["grib_get_string"]["bytes"] == len(shortName) + 1
+        with open(TEST_GRIB_TIGGE_DATA, "rb") as f:
+            message = eccodes.codes_any_new_from_file(f)
+        size = eccodes.codes_get_message_size(message)
+        eccodes.codes_release(message)
+        assert eccodes.stats()["codes_handle_new_from_file"]["bytes"] == size
+        eccodes.reset_stats()
+        assert eccodes.stats() == {}
+    finally:
+        eccodes.codes_set_stats(False)
+    eccodes.codes_get_long(gid, "edition")
+    assert eccodes.stats() == {}
+    eccodes.codes_release(gid)
+
+
+def test_live_handles():
+    def count(kind):
+        return eccodes.live_handles().get(kind, {}).get("count", 0)
+
+    handles, iterators = count("Handle"), count("KeysIterator")
+    gid = eccodes.codes_grib_new_from_samples("GRIB2")
+    iterid = eccodes.codes_keys_iterator_new(gid)
+    assert count("Handle") == handles + 1
+    assert count("KeysIterator") == iterators + 1
+    size = eccodes.codes_get_message_size(gid)
+    assert eccodes.live_handles()["Handle"]["bytes"] >= size
+    handle = eccodes.Handle(eccodes.codes_clone(gid))
+    assert eccodes.live_handles()["Handle"]["bytes"] >= 2 * size
+    del handle
+    eccodes.codes_keys_iterator_delete(iterid)
+    eccodes.codes_release(gid)
+    assert count("Handle") == handles
+    assert count("KeysIterator") == iterators
+
+
+def test_debug_handles():
+    eccodes.codes_set_debug_handles(True)
+    try:
+        gid = eccodes.codes_grib_new_from_samples("GRIB2")
+        handle = eccodes.Handle(eccodes.codes_clone(gid))
+    finally:
+        eccodes.codes_set_debug_handles(False)
+    report = eccodes.codes_leaked_handles_report()
+    assert f"Handle {gid:#x} created at" in report
+    assert "test_debug_handles" in report
+    eccodes.codes_release(gid)
+    del handle
+    assert f"{gid:#x}" not in eccodes.codes_leaked_handles_report()
+
+
+def test_scalar_getters_threads():
+    gid = eccodes.codes_grib_new_from_samples("GRIB2")
+    errors = []
+
+    def read_keys():
+        try:
+            for _ in range(1000):
+                assert eccodes.codes_get_long(gid, "edition") == 2
+                assert eccodes.codes_get_string(gid, "shortName") == "t"
+        except Exception as ex:
+            errors.append(ex)
+
+    threads = [threading.Thread(target=read_keys) for _ in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert errors == []
+    eccodes.codes_release(gid)
+
+
+def test_context_new():
+    context = eccodes.codes_context_new()
+    gid = eccodes.codes_grib_new_from_samples("GRIB2", context=context)
+    assert isinstance(gid, eccodes.Handle)
+    assert eccodes.codes_get_long(gid, "edition") == 2
+    message = eccodes.codes_get_message(gid)
+    gid2 = eccodes.codes_new_from_message(message, context=context)
+    assert eccodes.codes_get_long(gid2, "edition") == 2
+    eccodes.codes_release(gid2)
+    eccodes.codes_release(gid)
+    context.release()
+
+
+def test_clone_keeps_context():
+    def contexts():
+        return eccodes.live_handles().get("Context", {}).get("count", 0)
+
+    before = contexts()
+    context = eccodes.codes_context_new()
+    gid = eccodes.codes_grib_new_from_samples("GRIB2", context=context)
+    clone = eccodes.codes_clone(gid)
+    del context, gid
+    # The clone was created on the context of its source
+    assert contexts() == before + 1
+    assert eccodes.codes_get_long(clone, "edition") == 2
+    del clone
+    assert contexts() == before
+
+    # The message decoded in place keeps the bound context alive
+    gid = eccodes.codes_grib_new_from_samples("GRIB2")
+    buffer = eccodes.codes_get_message(gid)
+    eccodes.codes_release(gid)
+    with eccodes.codes_context_new():
+        handle = eccodes.codes_new_from_message(buffer, copy=False)
+    assert contexts() == before + 1
+    assert eccodes.codes_get_long(handle, "edition") == 2
+    del handle
+    assert contexts() == before
+
+
+def test_context_bind():
+    assert eccodes.codes_context_get_bound() is None
+    bound = []
+
+    def read_sample():
+        with eccodes.codes_context_new() as context:
+            gid = eccodes.codes_grib_new_from_samples("GRIB2")
+            bound.append(eccodes.codes_context_get_bound())
+            assert eccodes.codes_get_long(gid, "edition") == 2
+        assert eccodes.codes_context_get_bound() is None
+        # The message keeps its context alive
+        del context
+        assert eccodes.codes_get_long(gid, "edition") == 2
+        eccodes.codes_release(gid)
+
+    threads = [threading.Thread(target=read_sample) for _ in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert len(set(bound)) == 4
+    assert eccodes.codes_context_get_bound() is None
+
+
+def test_context_bind_shared():
+    shared = eccodes.codes_context_new()
+    other = eccodes.codes_context_new()
+    barrier = threading.Barrier(4)
+    bound = []
+
+    def enter_nested(outer):
+        with outer:
+            barrier.wait()
+            with shared:
+                barrier.wait()
+            # Each thread gets back its own binding
+            bound.append(eccodes.codes_context_get_bound() is outer)
+        bound.append(eccodes.codes_context_get_bound() is None)
+
+    contexts = [shared, other, shared, other]
+    threads = [threading.Thread(target=enter_nested, args=(c,)) for c in contexts]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert bound == [True] * 8
+
+
+def test_context_paths(tmp_path):
+    default_samples_path = eccodes.codes_samples_path()
+    context = eccodes.codes_context_new(samples_path=str(tmp_path), gts_header=False)
+    assert eccodes.codes_samples_path(context) == str(tmp_path)
+    assert eccodes.codes_samples_path() == default_samples_path
+    with context:
+        assert eccodes.codes_samples_path() == str(tmp_path)
+    eccodes.codes_set_samples_path(default_samples_path, context)
+    gid = eccodes.codes_grib_new_from_samples("GRIB2", context)
+    assert eccodes.codes_get_long(gid, "edition") == 2
+    eccodes.codes_release(gid)
+
+
+def test_arena_allocator():
+    arena = eccodes.ArenaAllocator(chunk_size=1024)
+    p1 = arena.malloc(10)
+    gribapi.ffi.memmove(p1, b"0123456789", 10)
+    # The last block grows in place, the others are moved
+    assert arena.realloc(p1, 100) == p1
+    p2 = arena.malloc(2000)
+    p3 = arena.realloc(p1, 200)
+    assert p3 != p1
+    assert gribapi.ffi.buffer(p3, 10)[:] == b"0123456789"
+    assert arena.blocks_in_use == 2
+    with pytest.raises(eccodes.GribInternalError):
+        arena.reset()
+    arena.free(p2)
+    arena.free(p3)
+    arena.reset()
+    assert arena.bytes_allocated == 0
+    assert arena.bytes_reserved == 1024
+
+
+def test_arena_allocator_foreign_pointer():
+    arena = eccodes.ArenaAllocator(chunk_size=1024)
+    default = gribapi.lib.grib_context_get_default()
+    # A block of the system allocator is grown and freed by the system allocator
+    pointer = gribapi.lib.grib_context_realloc(default, gribapi.ffi.NULL, 10)
+    gribapi.ffi.memmove(pointer, b"0123456789", 10)
+    pointer = arena.realloc(pointer, 4096)
+    assert pointer != gribapi.ffi.NULL
+    assert gribapi.ffi.buffer(pointer, 10)[:] == b"0123456789"
+    arena.free(pointer)
+    assert arena.blocks_in_use == 0
+    assert arena.bytes_reserved == 0
+
+
+def test_arena_allocator_threads():
+    arena = eccodes.ArenaAllocator(chunk_size=4096)
+
+    def allocate():
+        pointers = [arena.malloc(24) for _ in range(1000)]
+        pointers = [arena.realloc(p, 40) for p in pointers]
+        for p in pointers:
+            arena.free(p)
+        return sorted(int(gribapi.ffi.cast("size_t", p)) for p in pointers)
+
+    with concurrent.futures.ThreadPoolExecutor(4) as executor:
+        addresses = sum(executor.map(lambda _: allocate(), range(4)), [])
+    # No block was given to two threads
+    assert len(set(addresses)) == len(addresses)
+    assert arena.blocks_in_use == 0
+
+
+def test_context_allocator():
+    arena = eccodes.ArenaAllocator()
+    context = eccodes.codes_context_new(allocator=arena)
+    for _ in range(3):
+        gid = eccodes.codes_grib_new_from_samples("GRIB2", context)
+        assert eccodes.codes_get_long(gid, "edition") == 2
+        assert arena.blocks_in_use > 0
+        eccodes.codes_release(gid)
+        arena.reset()
+    with pytest.raises(eccodes.GribInternalError):
+        eccodes.codes_context_set_allocator(0, arena)
+
+
+def test_import_is_lazy():
+    # The library is found and opened on first use, not at import
+    subprocess.run(
+        [
+            sys.executable,
+            "-c",
+            "import eccodes, gribapi.bindings; assert gribapi.bindings.Library._lib is None;"
+            "eccodes.codes_get_api_version(); assert gribapi.bindings.Library._lib",
+        ],
+        check=True,
+    )
+
+
+def test_precompiled_declarations(tmp_path):
+    path = os.path.join(os.path.dirname(__file__), "..", "builder.py")
+    spec = importlib.util.spec_from_file_location("builder", path)
+    builder = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(builder)
+    module = runpy.run_path(builder.build_abi(str(tmp_path)))
+    # The declarations are saved with the hash of the headers they come from
+    bindings = gribapi.bindings
+    assert module["CDEF_HASH"] == bindings.cdef_hash(bindings.read_headers())
+    assert module["ffi"].sizeof("codes_handle*") == bindings.ffi.sizeof("void*")
+
+
 def test_codes_is_defined():
     gid = eccodes.codes_grib_new_from_samples("sh_sfc_grib1")
     assert eccodes.codes_is_defined(gid, "JS")
@@ -149,6 +462,22 @@ def test_new_from_message():
     eccodes.codes_release(newgid)
 
 
+def test_new_from_message_buffer():
+    gid = eccodes.codes_grib_new_from_samples("GRIB2")
+    buffer = bytearray(eccodes.codes_get_message(gid))
+    eccodes.codes_release(gid)
+    saved = gribapi.enable_type_checks, gribapi.enable_fast_path
+    try:
+        # Any buffer is accepted, also with the type checks on
+        eccodes.codes_set_type_checks(True)
+        for copy in [True, False]:
+            newgid = eccodes.codes_new_from_message(memoryview(buffer), copy=copy)
+            assert eccodes.codes_get_long(newgid, "edition") == 2
+            eccodes.codes_release(newgid)
+    finally:
+        eccodes.codes_set_type_checks(*saved)
+
+
 def test_gts_header():
     eccodes.codes_gts_header(True)
     eccodes.codes_gts_header(False)
@@ -163,6 +492,32 @@ def test_extract_offsets():
     assert offsets_list == expected
 
 
+def test_scan_references():
+    refs = list(
+        eccodes.codes_scan_references(
+            TEST_GRIB_TIGGE_DATA, ["shortName", "nonExistentKey"]
+        )
+    )
+    offsets = [0, 432, 864, 1296, 1728, 2160, 2616]
+    assert [ref["offset"] for ref in refs] == offsets
+    assert [ref["length"] for ref in refs[:-1]] == [
+        end - start for start, end in zip(offsets, offsets[1:])
+    ]
+    with open(TEST_GRIB_TIGGE_DATA, "rb") as f:
+        gid = eccodes.codes_grib_new_from_file(f)
+    assert refs[0]["shortName"] == eccodes.codes_get(gid, "shortName")
+    assert refs[0]["length"] == eccodes.codes_get_message_size(gid)
+    eccodes.codes_release(gid)
+    assert refs[0]["nonExistentKey"] is None
+    # The messages of any product loaded in full give the same references
+    any_refs = eccodes.codes_scan_references(
+        TEST_GRIB_TIGGE_DATA,
+        ["shortName", "nonExistentKey"],
+        eccodes.CODES_PRODUCT_ANY,
+    )
+    assert list(any_refs) == refs
+
+
 def _test_any_new_from_samples():
     msgid = eccodes.codes_new_from_samples(
         "reduced_gg_ml_grib2", eccodes.CODES_PRODUCT_ANY
@@ -287,6 +642,73 @@ def test_grib_clone():
     eccodes.codes_release(clone)
 
 
+def test_grib_handle_object():
+    gid = eccodes.codes_grib_new_from_samples("GRIB2")
+    handle = eccodes.Handle(gid)
+    assert handle == gid
+    assert eccodes.Handle(handle) is handle
+    assert eccodes.codes_get(handle, "totalLength") == 179
+    iterid = eccodes.codes_keys_iterator_new(handle, "ls")
+    assert isinstance(iterid, eccodes.KeysIterator)
+    assert eccodes.codes_keys_iterator_next(iterid)
+    eccodes.codes_keys_iterator_delete(iterid)
+    assert iterid.released
+    clone = eccodes.codes_clone(handle)
+    assert isinstance(clone, eccodes.Handle)
+    eccodes.codes_release(handle)
+    assert handle.released
+    # Releasing twice is harmless, using a released handle raises
+    eccodes.codes_release(handle)
+    with pytest.raises(eccodes.InvalidGribError):
+        eccodes.codes_get(handle, "totalLength")
+    clone_id = clone.detach()
+    assert type(clone_id) is int
+    assert eccodes.codes_get(clone_id, "identifier") == "GRIB"
+    eccodes.codes_release(clone_id)
+
+
+def test_release_with_children():
+    handle = eccodes.Handle(eccodes.codes_grib_new_from_samples("GRIB2"))
+    iterid = eccodes.codes_keys_iterator_new(handle, "ls")
+    # The iterator would be left with a dangling message
+    with pytest.raises(eccodes.InvalidGribError):
+        eccodes.codes_release(handle)
+    assert not handle.released
+    assert eccodes.codes_keys_iterator_next(iterid)
+    eccodes.codes_keys_iterator_delete(iterid)
+    eccodes.codes_release(handle)
+    assert handle.released
+
+    context = eccodes.codes_context_new()
+    gid = eccodes.codes_grib_new_from_samples("GRIB2", context=context)
+    with pytest.raises(eccodes.GribInternalError):
+        context.release()
+    del gid
+    context.release()
+
+    # Without strict the release waits for the children
+    handle = eccodes.Handle(eccodes.codes_grib_new_from_samples("GRIB2"))
+    iterid = eccodes.codes_keys_iterator_new(handle, "ls")
+    handle.release(strict=False)
+    assert handle.released
+    assert eccodes.codes_keys_iterator_next(iterid)
+    before = eccodes.live_handles()["Handle"]["count"]
+    eccodes.codes_keys_iterator_delete(iterid)
+    del iterid, handle
+    assert eccodes.live_handles().get("Handle", {}).get("count", 0) == before - 1
+
+    # The children are counted by the finalizers of any thread
+    handle = eccodes.Handle(eccodes.codes_grib_new_from_samples("GRIB2"))
+
+    def iterate(_):
+        for _ in range(100):
+            eccodes.codes_keys_iterator_new(handle, "ls")
+
+    with concurrent.futures.ThreadPoolExecutor(4) as executor:
+        list(executor.map(iterate, range(8)))
+    handle.release()
+
+
 def test_grib_keys_iterator():
     gid = eccodes.codes_grib_new_from_samples("reduced_gg_pl_1280_grib1")
     iterid = eccodes.eccodes.codes_keys_iterator_new(gid, "ls")
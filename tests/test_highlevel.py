@@ -1,6 +1,8 @@
 import collections
+import concurrent.futures
 import itertools
 import pathlib
+import pickle
 
 import numpy as np
 import pytest
@@ -18,6 +20,14 @@ def test_filereader():
     assert count == 7
 
 
+def test_filereader_context():
+    context = eccodes.codes_context_new()
+    with eccodes.FileReader(TEST_GRIB_DATA, context=context) as reader:
+        messages = list(reader)
+    assert len(messages) == 7
+    assert messages[0]["edition"] == 2
+
+
 def test_read_message():
     with eccodes.FileReader(TEST_GRIB_DATA) as reader:
         message = next(reader)
@@ -141,3 +151,184 @@ def test_message_from_samples():
     assert message["edition"] == 2
     assert message["gridType"] == "regular_ll"
     assert message["levtype"] == "sfc"
+
+
+def test_tracer(tmp_path):
+    tracer = eccodes.MemoryTracer()
+    previous = eccodes.set_tracer(tracer)
+    try:
+        with eccodes.FileReader(TEST_GRIB_DATA) as reader:
+            message = next(reader)
+            message.data
+            with open(tmp_path / "out.grib", "wb") as fout:
+                message.write_to(fout)
+    finally:
+        eccodes.set_tracer(previous)
+    assert [span.name for span in tracer.spans] == [
+        "eccodes.read",
+        "eccodes.decode",
+        "eccodes.write",
+    ]
+    read = tracer.spans[0]
+    assert read.attributes["reader"] == "FileReader"
+    assert read.attributes["offset"] == 0
+    assert read.attributes["edition"] == 2
+    assert read.attributes["size"] == (tmp_path / "out.grib").stat().st_size
+    assert tracer.spans[1].attributes["values"] == message.data.size
+    assert len(tracer.durations("eccodes.read")) == 1
+
+
+def test_data_cache():
+    try:
+        eccodes.set_data_cache("none")
+        with eccodes.FileReader(TEST_GRIB_DATA) as reader:
+            message = next(reader)
+            assert message.data is not message.data
+            assert np.array_equal(message.data, message.data)
+
+        eccodes.set_data_cache("weakref")
+        with eccodes.FileReader(TEST_GRIB_DATA) as reader:
+            message = next(reader)
+            data = message.data
+            assert message.data is data
+
+        nbytes = data.nbytes
+        cache = eccodes.set_data_cache("lru", max_bytes=2 * nbytes)
+        with eccodes.FileReader(TEST_GRIB_DATA) as reader:
+            messages = list(reader)
+        for message in messages:
+            assert message.data is message.data
+        info = cache.info()
+        assert info["nbytes"] <= 2 * nbytes
+        assert info["evictions"] == len(messages) - 2
+        assert info["hits"] == len(messages)
+        del messages, message
+        assert cache.info()["items"] == 0
+    finally:
+        eccodes.set_data_cache("message")
+
+
+def test_filereader_recycle():
+    with eccodes.FileReader(TEST_GRIB_DATA) as reader:
+        expected = [message.data for message in reader]
+
+    with eccodes.FileReader(TEST_GRIB_DATA, recycle=True) as reader:
+        messages = []
+        for message, data in zip(reader, expected):
+            assert np.array_equal(message.data, data)
+            messages.append(message)
+    assert len(messages) == 7
+    # Each message is released when the next one is read
+    with pytest.raises(eccodes.InvalidGribError):
+        messages[0]["shortName"]
+
+    with eccodes.FileReader(TEST_GRIB_DATA, recycle=True) as reader:
+        assert reader.file is None
+        message = next(reader)
+        assert reader.read_at(0)["shortName"] == message["shortName"]
+        # A message with objects created from it keeps its buffer until they are gone
+        iterator = eccodes.codes_keys_iterator_new(message._handle)
+        assert np.array_equal(next(reader).data, expected[1])
+        with pytest.raises(eccodes.InvalidGribError):
+            message["shortName"]
+        assert eccodes.codes_keys_iterator_next(iterator)
+        eccodes.codes_keys_iterator_delete(iterator)
+        assert len(list(reader)) == 5
+
+
+def test_message_items():
+    with eccodes.FileReader(TEST_GRIB_DATA2) as reader:
+        message = next(reader)
+        for namespace in [None, "mars", "ls"]:
+            items = list(message.items(namespace))
+            expected = [(key, message.get(key)) for key in message.keys(namespace)]
+            assert [key for key, _ in items] == [key for key, _ in expected]
+            for (_, value), (_, value2) in zip(items, expected):
+                if isinstance(value, np.ndarray):
+                    assert np.array_equal(value, value2)
+                else:
+                    assert value == value2
+
+
+def test_message_pickle():
+    with eccodes.FileReader(TEST_GRIB_DATA) as reader:
+        message = next(reader)
+        message["centre"] = "lfpw"
+
+    copy = pickle.loads(pickle.dumps(message, protocol=4))
+    assert isinstance(copy, eccodes.GRIBMessage)
+    assert copy["centre"] == "lfpw"
+    assert np.array_equal(copy.data, message.data)
+
+    buffers = []
+    data = pickle.dumps(message, protocol=5, buffer_callback=buffers.append)
+    assert len(buffers) == 1
+    assert len(data) < len(buffers[0].raw())
+    copy = pickle.loads(data, buffers=buffers)
+    assert copy.get_buffer() == message.get_buffer()
+
+
+def test_shared_memory():
+    with eccodes.FileReader(TEST_GRIB_DATA) as reader:
+        messages = list(reader)
+    shared = [eccodes.share(m, values=i % 2 == 0) for i, m in enumerate(messages)]
+    try:
+        with eccodes.SharedMemoryReader(pickle.loads(pickle.dumps(shared))) as reader:
+            copies = list(reader)
+            for message, copy in zip(messages, copies):
+                assert copy.get_buffer() == message.get_buffer()
+                assert np.array_equal(copy.data, message.data)
+            data = copies[0].data
+            assert not data.flags.writeable
+        with pytest.raises(eccodes.InvalidGribError):
+            copies[0]["shortName"]
+        assert np.array_equal(data, messages[0].data)
+
+        # The reader holds the context bound when it was created
+        with eccodes.codes_context_new() as context:
+            reader = eccodes.SharedMemoryReader(shared)
+        del context
+        with reader:
+            assert type(reader.context) is eccodes.Context
+            assert next(reader)["shortName"] == messages[0]["shortName"]
+    finally:
+        for s in shared:
+            s.unlink()
+
+
+def read_shared(shared):
+    with eccodes.SharedMemoryReader([shared]) as reader:
+        message = next(reader)
+        return message["shortName"], message.data.sum()
+
+
+def test_shared_memory_processes():
+    with eccodes.FileReader(TEST_GRIB_DATA) as reader:
+        messages = list(reader)
+    shared = [eccodes.share(m, values=i % 2 == 0) for i, m in enumerate(messages)]
+    try:
+        with concurrent.futures.ProcessPoolExecutor(2) as executor:
+            results = list(executor.map(read_shared, shared))
+        assert results == [(m["shortName"], m.data.sum()) for m in messages]
+        # The segments outlive the processes which attached them
+        assert list(map(read_shared, shared)) == results
+    finally:
+        for s in shared:
+            s.unlink()
+
+
+def test_scan_table():
+    with eccodes.FileReader(TEST_GRIB_DATA2) as reader:
+        message = next(reader)
+        table = reader.scan_table(["shortName", "level", "nonExistentKey"], "numpy")
+        assert next(reader)["offset"] == table["offset"][1]
+    assert len(table) == 160
+    assert table["offset"][0] == 0
+    assert table["length"][0] == message["totalLength"]
+    assert table["shortName"][0] == message["shortName"]
+    assert table["level"].dtype == np.int64
+    assert np.isnan(table["nonExistentKey"]).all()
+
+    with eccodes.FileReader(TEST_GRIB_DATA2) as reader:
+        with pytest.raises(ValueError):
+            reader.scan_table(["shortName", "offset"])